@@ -6,413 +6,3897 @@
 #include <string>
 #include <stdexcept>
 #include <sstream>
+#include <iomanip>
 #include <set>
+#include <map>
 #include <nlohmann/json.hpp>
 #include <fstream>
+#include <cstdio>
+#include <tuple>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <memory>
+#include <new>
+#include <cstring>
+#include <charconv>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <cmath>
+#include <utility>
+#include <type_traits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // Struktura przechowująca dane o stanie gry
-// Zawiera pozycję gracza, wynik i datę zapisu
+// Zawiera pozycję gracza, wynik i datę zapisu (sekundy od epoki Unix)
 struct GameData {
     sf::Vector2f position;
-    int score;
-    std::string date;
+    int score = 0;
+    std::int64_t date = 0;
+    std::uint64_t seed = 0;     // Ziarno generatora liczb losowych sesji (0 - nieznane, zapisy sprzed wersji 2)
 };
 
-// Funkcja zapisująca stan gry do pliku JSON
+// Pliki zapisu: binarny snapshot (pełna historia), dziennik dopisywanych zapisów
+// i stary format JSON, który służy już tylko do importu/eksportu
+const std::string scoreSnapshotFile = "sscore.bin";
+const std::string scoreJournalFile = "sscore.bin.journal";
+const std::string scoreJsonFile = "sscore.json";
+
+// Formatowanie daty zapisu do postaci czytelnej dla człowieka (czas lokalny)
+std::string formatDate(std::int64_t date) {
+    std::time_t time = static_cast<std::time_t>(date);
+    char buf[80];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&time));
+    return buf;
+}
+
+// Odczyt daty w formacie "RRRR-MM-DD[ GG:MM[:SS]]" (czas lokalny)
+// Stare zapisy zawierają samą datę - brakujący czas to północ
+std::int64_t parseDate(const std::string& text) {
+    std::tm tm = {};
+    tm.tm_isdst = -1;
+    int parsed = std::sscanf(text.c_str(), "%d-%d-%d %d:%d:%d",
+                             &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec);
+    if (parsed < 3 || parsed == 4) {
+        throw std::runtime_error("Niepoprawna data: " + text);
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    return static_cast<std::int64_t>(std::mktime(&tm));
+}
+
+// Konwersja pojedynczego zapisu do JSON
+nlohmann::json gameDataToJson(const GameData& gameData) {
+    nlohmann::json entry;
+    entry["position"] = {gameData.position.x, gameData.position.y};
+    entry["score"] = gameData.score;
+    entry["date"] = formatDate(gameData.date);
+    entry["seed"] = gameData.seed;
+    return entry;
+}
+
+// Tworzy zapis bieżącego stanu gry z aktualną datą
+GameData makeGameData(const sf::Vector2f& position, int score, std::uint64_t seed) {
+    GameData gameData;
+    gameData.position = position;
+    gameData.score = score;
+    gameData.seed = seed;
+    gameData.date = static_cast<std::int64_t>(std::time(nullptr));
+    return gameData;
+}
+
+// Zapis do pliku tymczasowego, fsync i podmiana przez rename
+// Po awarii na dysku zostaje albo stara, albo nowa wersja pliku - nigdy połowa
+bool writeFileAtomically(const std::string& filename, const std::string& contents) {
+    const std::string tempFilename = filename + ".tmp";
+    std::FILE* file = std::fopen(tempFilename.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    ok = std::fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::remove(tempFilename.c_str());
+        return false;
+    }
+    return std::rename(tempFilename.c_str(), filename.c_str()) == 0;
+}
+
+// Plik zmapowany w pamięci tylko do odczytu (mmap)
+// System wczytuje z dysku tylko te strony, których faktycznie dotkniemy
+class MappedFile {
+private:
+    const unsigned char* bytes = nullptr;
+    std::size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                bytes = static_cast<const unsigned char*>(mapping);
+                length = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (bytes) {
+            ::munmap(const_cast<unsigned char*>(bytes), length);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+};
+
+// Binarny format zapisów (wersja 1, natywna kolejność bajtów)
+// Snapshot: nagłówek + rekordy o stałej długości; dziennik: same rekordy
+struct SaveFileHeader {
+    char magic[4];              // "SGSV"
+    std::uint32_t version;      // Wersja formatu
+    std::uint32_t recordSize;   // sizeof(SaveRecord) - kontrola zgodności
+    std::uint32_t checksum;     // FNV-1a wszystkich bajtów rekordów
+    std::uint64_t recordCount;  // Liczba rekordów za nagłówkiem
+};
+
+// Rekord w wersji 2 - z ziarnem generatora sesji
+struct SaveRecord {
+    float x;
+    float y;
+    std::int32_t score;
+    std::uint32_t reserved;
+    std::int64_t date;          // Sekundy od epoki Unix
+    std::uint64_t seed;         // Ziarno generatora liczb losowych sesji
+};
+
+// Rekord w wersji 1 (tylko do odczytu starych plików) - ten sam układ bez ziarna
+struct SaveRecordV1 {
+    float x;
+    float y;
+    std::int32_t score;
+    std::uint32_t reserved;
+    std::int64_t date;
+};
+
+// Nagłówek dziennika od wersji 2; dziennik w wersji 1 to same rekordy bez nagłówka
+// Dziennik dopisuje się do konkretnego snapshotu: gdy snapshot ma już inną sumę kontrolną,
+// rekordy dziennika zostały do niego przeniesione (kompaktowanie przerwane przed wyczyszczeniem dziennika)
+struct JournalHeader {
+    char magic[4];              // "SGJN"
+    std::uint32_t version;
+    std::uint32_t recordSize;
+    std::uint32_t snapshotChecksum;  // Suma kontrolna snapshotu bazowego (0 - dziennik sprzed tego pola)
+};
+
+static_assert(sizeof(SaveFileHeader) == 24, "Zmiana układu nagłówka wymaga nowej wersji formatu");
+static_assert(sizeof(SaveRecord) == 32, "Zmiana układu rekordu wymaga nowej wersji formatu");
+static_assert(sizeof(SaveRecordV1) == 24, "Układ rekordu w wersji 1 jest zamrożony");
+static_assert(sizeof(JournalHeader) == 16, "Zmiana układu nagłówka dziennika wymaga nowej wersji formatu");
+static_assert(offsetof(SaveRecord, date) == offsetof(SaveRecordV1, date), "Data musi leżeć w tym samym miejscu we wszystkich wersjach");
+
+const std::uint32_t saveFileVersion = 2;
+
+// Rozmiar rekordu w danej wersji formatu (0 dla nieznanej wersji)
+std::size_t saveRecordSize(std::uint32_t version) {
+    return version == 2 ? sizeof(SaveRecord) : version == 1 ? sizeof(SaveRecordV1) : 0;
+}
+
+SaveRecord toSaveRecord(const GameData& gameData) {
+    SaveRecord record = {};
+    record.x = gameData.position.x;
+    record.y = gameData.position.y;
+    record.score = gameData.score;
+    record.date = gameData.date;
+    record.seed = gameData.seed;
+    return record;
+}
+
+// Odczyt rekordu w dowolnej obsługiwanej wersji jako rekordu w bieżącej wersji
+SaveRecord readSaveRecord(const unsigned char* bytes, std::uint32_t version) {
+    SaveRecord record = {};
+    if (version == 1) {
+        SaveRecordV1 old;
+        std::memcpy(&old, bytes, sizeof(old));
+        record.x = old.x;
+        record.y = old.y;
+        record.score = old.score;
+        record.date = old.date;
+    } else {
+        std::memcpy(&record, bytes, sizeof(record));
+    }
+    return record;
+}
+
+GameData fromSaveRecord(const SaveRecord& record) {
+    GameData gameData;
+    gameData.position = sf::Vector2f(record.x, record.y);
+    gameData.score = record.score;
+    gameData.date = record.date;
+    gameData.seed = record.seed;
+    return gameData;
+}
+
+GameData fromSaveRecord(const unsigned char* bytes, std::uint32_t version = saveFileVersion) {
+    return fromSaveRecord(readSaveRecord(bytes, version));
+}
+
+// Ciągła tablica rekordów w zmapowanym pliku (snapshot albo dziennik) w jednej wersji formatu
+struct SaveRecordSpan {
+    const unsigned char* data = nullptr;
+    std::size_t count = 0;
+    std::uint32_t version = saveFileVersion;
+
+    std::size_t stride() const {
+        return saveRecordSize(version);
+    }
+
+    const unsigned char* at(std::size_t i) const {
+        return data + i * stride();
+    }
+
+    SaveRecord record(std::size_t i) const {
+        return readSaveRecord(at(i), version);
+    }
+};
+
+// Suma kontrolna FNV-1a (32 bity)
+std::uint32_t fnv1a(const unsigned char* bytes, std::size_t length, std::uint32_t hash = 2166136261u) {
+    for (std::size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Sprawdza nagłówek snapshotu (wersja 1 albo 2); przy błędzie span.data == nullptr
+SaveRecordSpan snapshotRecords(const MappedFile& file) {
+    SaveRecordSpan span;
+    if (file.size() < sizeof(SaveFileHeader)) {
+        return span;
+    }
+    SaveFileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const std::size_t recordSize = saveRecordSize(header.version);
+    if (std::memcmp(header.magic, "SGSV", 4) != 0 || recordSize == 0 || header.recordSize != recordSize ||
+        header.recordCount > (file.size() - sizeof(SaveFileHeader)) / recordSize) {
+        return span;
+    }
+    span.data = file.data() + sizeof(SaveFileHeader);
+    span.count = static_cast<std::size_t>(header.recordCount);
+    span.version = header.version;
+    return span;
+}
+
+// Rekordy dziennika: od wersji 2 za nagłówkiem, w wersji 1 od początku pliku
+// Niepełny ostatni rekord (przerwany zapis) jest pomijany
+SaveRecordSpan journalRecords(const MappedFile& file) {
+    SaveRecordSpan span;
+    span.data = file.data();
+    span.version = 1;
+    if (file.size() >= sizeof(JournalHeader) && std::memcmp(file.data(), "SGJN", 4) == 0) {
+        JournalHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (saveRecordSize(header.version) == 0 || header.recordSize != saveRecordSize(header.version)) {
+            return SaveRecordSpan();
+        }
+        span.data = file.data() + sizeof(JournalHeader);
+        span.version = header.version;
+        span.count = (file.size() - sizeof(JournalHeader)) / span.stride();
+        return span;
+    }
+    span.count = file.size() / span.stride();
+    return span;
+}
+
+// Zapis pełnej listy zapisów do binarnego snapshotu (atomowo)
+bool saveScoreSnapshot(const std::string& filename, const std::vector<GameData>& gameDataList) {
+    std::string contents(sizeof(SaveFileHeader) + gameDataList.size() * sizeof(SaveRecord), '\0');
+    unsigned char* records = reinterpret_cast<unsigned char*>(&contents[sizeof(SaveFileHeader)]);
+    for (std::size_t i = 0; i < gameDataList.size(); ++i) {
+        SaveRecord record = toSaveRecord(gameDataList[i]);
+        std::memcpy(records + i * sizeof(SaveRecord), &record, sizeof(record));
+    }
+
+    SaveFileHeader header = {};
+    std::memcpy(header.magic, "SGSV", 4);
+    header.version = saveFileVersion;
+    header.recordSize = sizeof(SaveRecord);
+    header.recordCount = gameDataList.size();
+    header.checksum = fnv1a(records, gameDataList.size() * sizeof(SaveRecord));
+    std::memcpy(&contents[0], &header, sizeof(header));
+
+    if (!writeFileAtomically(filename, contents)) {
+        std::cerr << "Nie udało się zapisać pliku " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Wczytanie całego snapshotu z weryfikacją sumy kontrolnej
+// Zwraca false, gdy plik istnieje, ale jest uszkodzony
+bool loadScoreSnapshot(const std::string& filename, std::vector<GameData>& gameDataList) {
+    MappedFile file(filename);
+    if (file.size() == 0) {
+        return true;
+    }
+
+    const SaveRecordSpan records = snapshotRecords(file);
+    SaveFileHeader header;
+    std::memcpy(&header, file.data(), std::min(file.size(), sizeof(header)));
+    if (!records.data || fnv1a(records.data, records.count * records.stride()) != header.checksum) {
+        std::cerr << "Uszkodzony plik zapisu " << filename << std::endl;
+        return false;
+    }
+
+    gameDataList.reserve(gameDataList.size() + records.count);
+    for (std::size_t i = 0; i < records.count; ++i) {
+        gameDataList.push_back(fromSaveRecord(records.record(i)));
+    }
+    return true;
+}
+
+JournalHeader makeJournalHeader(std::uint32_t snapshotChecksum) {
+    JournalHeader header = {};
+    std::memcpy(header.magic, "SGJN", 4);
+    header.version = saveFileVersion;
+    header.recordSize = sizeof(SaveRecord);
+    header.snapshotChecksum = snapshotChecksum;
+    return header;
+}
+
+// Suma kontrolna rekordów snapshotu; brak snapshotu liczy się jak snapshot bez rekordów
+std::uint32_t snapshotChecksum(const MappedFile& snapshot) {
+    if (snapshot.size() < sizeof(SaveFileHeader)) {
+        return fnv1a(nullptr, 0);
+    }
+    SaveFileHeader header;
+    std::memcpy(&header, snapshot.data(), sizeof(header));
+    return header.checksum;
+}
+
+// Dziennik, którego rekordy są już w snapshocie - kompaktowanie podmieniło snapshot, ale nie zdążyło
+// wyczyścić dziennika. Taki dziennik jest pomijany przy odczycie i czyszczony przy następnym zapisie
+bool isJournalCompacted(const MappedFile& journal, const MappedFile& snapshot) {
+    if (journal.size() < sizeof(JournalHeader) || std::memcmp(journal.data(), "SGJN", 4) != 0) {
+        return false;
+    }
+    JournalHeader header;
+    std::memcpy(&header, journal.data(), sizeof(header));
+    return header.snapshotChecksum != 0 && header.snapshotChecksum != snapshotChecksum(snapshot);
+}
+
+// Rekordy dziennika, które jeszcze nie trafiły do snapshotu
+SaveRecordSpan journalRecords(const MappedFile& journal, const MappedFile& snapshot) {
+    SaveRecordSpan span = journalRecords(journal);
+    if (isJournalCompacted(journal, snapshot)) {
+        span.count = 0;
+    }
+    return span;
+}
+
+void appendSaveRecords(const SaveRecordSpan& records, std::vector<GameData>& gameDataList) {
+    gameDataList.reserve(gameDataList.size() + records.count);
+    for (std::size_t i = 0; i < records.count; ++i) {
+        gameDataList.push_back(fromSaveRecord(records.record(i)));
+    }
+}
+
+// Wczytuje zapisy z dziennika; niepełny ostatni rekord (przerwany zapis) jest pomijany
+void loadScoreJournal(const std::string& filename, std::vector<GameData>& gameDataList) {
+    MappedFile file(filename);
+    appendSaveRecords(journalRecords(file), gameDataList);
+}
+
+// Przepisanie dziennika w starszej wersji do bieżącej (jednorazowo, atomowo)
+// Dziennik w wersji 1 nie ma nagłówka, więc zawsze dotyczy bieżącego snapshotu
+bool upgradeScoreJournal(const std::string& filename, std::uint32_t baseChecksum) {
+    std::vector<GameData> gameDataList;
+    loadScoreJournal(filename, gameDataList);
+
+    const JournalHeader header = makeJournalHeader(baseChecksum);
+    std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const GameData& gameData : gameDataList) {
+        const SaveRecord record = toSaveRecord(gameData);
+        contents.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    }
+    if (!writeFileAtomically(filename, contents)) {
+        std::cerr << "Nie udało się przepisać dziennika " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Dziennik przepisany do wersji " << saveFileVersion << " (" << gameDataList.size() << " zapisów)" << std::endl;
+    return true;
+}
+
+// Dopisuje jeden rekord na końcu dziennika i czeka na zapis na dysk (fsync)
+// Koszt nie zależy od liczby wcześniejszych zapisów
+bool appendScoreToJournal(const std::string& snapshotFile, const std::string& filename, const GameData& gameData) {
+    std::uint32_t journalVersion = saveFileVersion;
+    std::uint32_t baseChecksum = 0;
+    bool empty = true;
+    std::size_t fileSize = 0;
+    std::size_t validSize = 0;
+    {
+        MappedFile snapshot(snapshotFile);
+        MappedFile existing(filename);
+        baseChecksum = snapshotChecksum(snapshot);
+        if (isJournalCompacted(existing, snapshot)) {
+            // Rekordy są już w snapshocie - dziennik zaczyna się od nowa
+            fileSize = existing.size();
+        } else if (existing.size() > 0) {
+            const SaveRecordSpan records = journalRecords(existing);
+            if (!records.data) {
+                std::cerr << "Uszkodzony nagłówek dziennika zapisów!" << std::endl;
+                return false;
+            }
+            empty = false;
+            journalVersion = records.version;
+            fileSize = existing.size();
+            validSize = static_cast<std::size_t>(records.data - existing.data()) + records.count * records.stride();
+        }
+    }
+    if (!empty && journalVersion != saveFileVersion) {
+        if (!upgradeScoreJournal(filename, baseChecksum)) {
+            return false;
+        }
+    } else if (validSize < fileSize && ::truncate(filename.c_str(), static_cast<off_t>(validSize)) != 0) {
+        // Niepełny rekord po przerwanym zapisie (albo dziennik już przeniesiony do snapshotu) jest odcinany -
+        // nowy rekord dopisany za nim byłby przesunięty
+        std::cerr << "Nie można obciąć niepełnego rekordu dziennika!" << std::endl;
+        return false;
+    }
+
+    std::FILE* file = std::fopen(filename.c_str(), "ab");
+    if (!file) {
+        std::cerr << "Nie można otworzyć dziennika zapisów!" << std::endl;
+        return false;
+    }
+    bool ok = true;
+    if (empty) {
+        const JournalHeader header = makeJournalHeader(baseChecksum);
+        ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    SaveRecord record = toSaveRecord(gameData);
+    ok = std::fwrite(&record, sizeof(record), 1, file) == 1 && ok;
+    ok = std::fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Wczytuje całą historię zapisów: snapshot, a po nim dziennik
+bool loadScoreHistory(const std::string& snapshotFile, const std::string& journalFile, std::vector<GameData>& gameDataList) {
+    gameDataList.clear();
+    if (!loadScoreSnapshot(snapshotFile, gameDataList)) {
+        return false;
+    }
+    MappedFile snapshot(snapshotFile);
+    MappedFile journal(journalFile);
+    appendSaveRecords(journalRecords(journal, snapshot), gameDataList);
+    return true;
+}
+
+// Eksport listy zapisów do pliku JSON
 void saveScoreToJson(const std::string& filename, const std::vector<GameData>& gameDataList) {
     nlohmann::json jsonData;
-    std::ifstream inputFile(filename);
-    if (inputFile.is_open()) {
-        try {
-            inputFile >> jsonData;
-        } catch (const std::exception& e) {
-            std::cerr << "Błąd " << e.what() << std::endl;
+    jsonData["games"] = nlohmann::json::array();
+    for (const auto& gameData : gameDataList) {
+        jsonData["games"].push_back(gameDataToJson(gameData));
+    }
+
+    if (!writeFileAtomically(filename, jsonData.dump(4))) {
+        std::cerr << "Nie udało się zapisać pliku " << filename << std::endl;
+    }
+}
+
+// Strumieniowy import JSON (SAX): wpisy z games[] trafiają od razu do GameData,
+// bez budowania drzewa nlohmann::json. Niepoprawny wpis jest odrzucany, reszta wczytuje się normalnie
+class GameDataSaxImporter : public nlohmann::json_sax<nlohmann::json> {
+private:
+    // Głębokości zagnieżdżenia w oczekiwanym układzie {"games": [{"position": [x, y], ...}]}
+    static constexpr int gamesArrayDepth = 2;
+    static constexpr int recordDepth = 3;
+    static constexpr int positionDepth = 4;
+
+    std::vector<GameData>& gameDataList;
+    int depth = 0;
+    bool inGames = false;
+    bool inRecord = false;
+    bool inPosition = false;
+    std::string currentKey;
+    GameData current;
+    int positionCount = 0;
+    bool hasScore = false;
+    bool hasDate = false;
+    bool recordValid = true;
+
+    // Element games[], który nie jest obiektem (liczba, tekst, tablica...) - liczony jako odrzucony wpis
+    void countNonRecordElement() {
+        if (inGames && !inRecord && depth == gamesArrayDepth) {
+            ++rejected;
+        }
+    }
+
+    bool isSeedKey() const {
+        return inRecord && !inPosition && depth == recordDepth && currentKey == "seed";
+    }
+
+    // Wartość liczbowa wewnątrz rekordu
+    void number(double value, bool isInteger) {
+        if (!inRecord) {
+            countNonRecordElement();
+            return;
+        }
+        if (inPosition && depth == positionDepth) {
+            if (positionCount == 0) {
+                current.position.x = static_cast<float>(value);
+            } else if (positionCount == 1) {
+                current.position.y = static_cast<float>(value);
+            }
+            ++positionCount;
+        } else if (depth == recordDepth && currentKey == "score") {
+            if (!isInteger || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+                recordValid = false;
+                return;
+            }
+            current.score = static_cast<int>(value);
+            hasScore = true;
+        } else if (depth == recordDepth && (currentKey == "date" || currentKey == "position" || currentKey == "seed")) {
+            recordValid = false;
+        } else if (inPosition) {
+            recordValid = false;
+        }
+    }
+
+    // Wartość innego typu niż liczba/tekst w miejscu znanego pola
+    void unexpectedValue() {
+        countNonRecordElement();
+        if (inRecord && (inPosition || (depth == recordDepth && (currentKey == "score" || currentKey == "date" || currentKey == "position" || currentKey == "seed")))) {
+            recordValid = false;
+        }
+    }
+
+public:
+    std::size_t accepted = 0;   // Liczba wczytanych wpisów
+    std::size_t rejected = 0;   // Liczba odrzuconych wpisów
+    bool syntaxError = false;   // Parsowanie przerwane błędem składni
+
+    explicit GameDataSaxImporter(std::vector<GameData>& output) : gameDataList(output) {}
+
+    bool null() override { unexpectedValue(); return true; }
+    bool boolean(bool) override { unexpectedValue(); return true; }
+    // Ziarno (opcjonalne) jest 64-bitowe - czytane bez przejścia przez double, które gubi bity
+    bool number_integer(number_integer_t value) override {
+        if (isSeedKey()) {
+            if (value < 0) {
+                recordValid = false;
+            }
+            current.seed = static_cast<std::uint64_t>(value);
+            return true;
+        }
+        number(static_cast<double>(value), true);
+        return true;
+    }
+    bool number_unsigned(number_unsigned_t value) override {
+        if (isSeedKey()) {
+            current.seed = value;
+            return true;
+        }
+        number(static_cast<double>(value), true);
+        return true;
+    }
+    bool number_float(number_float_t value, const string_t&) override { number(value, false); return true; }
+    bool binary(binary_t&) override { unexpectedValue(); return true; }
+
+    bool string(string_t& value) override {
+        if (inRecord && depth == recordDepth && currentKey == "date") {
+            try {
+                current.date = parseDate(value);
+                hasDate = true;
+            } catch (const std::exception&) {
+                recordValid = false;
+            }
+        } else {
+            unexpectedValue();
+        }
+        return true;
+    }
+
+    bool key(string_t& value) override {
+        if (depth == 1 || (inRecord && depth == recordDepth)) {
+            currentKey = value;
+        }
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        if (inGames && depth == gamesArrayDepth) {
+            inRecord = true;
+            current = GameData();
+            positionCount = 0;
+            hasScore = false;
+            hasDate = false;
+            recordValid = true;
+        } else {
+            unexpectedValue();
+        }
+        ++depth;
+        return true;
+    }
+
+    bool end_object() override {
+        --depth;
+        if (inRecord && depth == gamesArrayDepth) {
+            inRecord = false;
+            if (recordValid && hasScore && hasDate && positionCount == 2) {
+                gameDataList.push_back(current);
+                ++accepted;
+            } else {
+                ++rejected;
+            }
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        if (depth == 1 && currentKey == "games") {
+            inGames = true;
+        } else if (inRecord && depth == recordDepth && currentKey == "position") {
+            inPosition = true;
+        } else {
+            unexpectedValue();
+        }
+        ++depth;
+        return true;
+    }
+
+    bool end_array() override {
+        --depth;
+        if (inPosition && depth == recordDepth) {
+            inPosition = false;
+        } else if (inGames && depth == 1) {
+            inGames = false;
+        }
+        return true;
+    }
+
+    // Błąd składni przerywa parsowanie; wpisy wczytane wcześniej zostają, przerwany wpis jest odrzucany
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception& e) override {
+        std::cerr << "Błąd składni JSON na pozycji " << position << ": " << e.what() << std::endl;
+        syntaxError = true;
+        if (inRecord) {
+            inRecord = false;
+            ++rejected;
+        }
+        return false;
+    }
+};
+
+// Import zapisów z pliku JSON (także ze starszych wersji gry)
+// Plik jest mapowany w pamięci i parsowany strumieniowo, więc zużycie pamięci zależy tylko od liczby zapisów
+bool loadScoreFromJson(const std::string& filename, std::vector<GameData>& gameDataList) {
+    MappedFile file(filename);
+    if (file.size() == 0) {
+        std::cerr << "Nie udało się otworzyć pliku do wczytania stanu gry!" << std::endl;
+        return false;
+    }
+
+    // Sformatowany wpis zajmuje ok. 150 bajtów, zwarty ok. 70 - rezerwacja z zapasem dla obu
+    gameDataList.reserve(gameDataList.size() + file.size() / 64);
+
+    const auto start = std::chrono::steady_clock::now();
+    GameDataSaxImporter importer(gameDataList);
+    const char* begin = reinterpret_cast<const char*>(file.data());
+    nlohmann::json::sax_parse(begin, begin + file.size(), &importer);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double megabytes = static_cast<double>(file.size()) / (1024.0 * 1024.0);
+    std::cout << "Import " << filename << ": " << importer.accepted << " wpisów, odrzucono " << importer.rejected
+              << ", " << (seconds > 0 ? megabytes / seconds : 0.0) << " MB/s" << std::endl;
+
+    // Uszkodzony koniec pliku nie przekreśla wpisów wczytanych przed błędem składni
+    return !importer.syntaxError || importer.accepted > 0;
+}
+
+// Stara wersja gry dopisywała przy każdym zapisie całą listę, więc sscore.json zawiera wielokrotne kopie
+// tych samych wpisów. Duplikaty są usuwane tylko przy imporcie JSON - dziennik i snapshot binarny
+// dostają każdy zapis dokładnie raz, więc dwa prawdziwe zapisy z tej samej sekundy i pozycji zostają
+void removeLegacyDuplicates(std::vector<GameData>& gameDataList) {
+    std::set<std::tuple<std::int64_t, int, float, float>> seen;
+    gameDataList.erase(std::remove_if(gameDataList.begin(), gameDataList.end(), [&](const GameData& gameData) {
+        return !seen.insert({gameData.date, gameData.score, gameData.position.x, gameData.position.y}).second;
+    }), gameDataList.end());
+}
+
+// Kompaktowanie: przenosi dziennik do snapshotu posortowanego według daty
+// Uruchamiane poza grą (./prog --compact) i okresowo przez wątek zapisów
+void compactScoreJournal(const std::string& snapshotFile, const std::string& journalFile) {
+    std::vector<GameData> gameDataList;
+    if (!loadScoreHistory(snapshotFile, journalFile, gameDataList)) {
+        std::cerr << "Kompaktowanie przerwane - snapshot jest uszkodzony" << std::endl;
+        return;
+    }
+
+    // Snapshot posortowany według daty pozwala indeksowi szukać zakresów dat binarnie
+    std::stable_sort(gameDataList.begin(), gameDataList.end(), [](const GameData& a, const GameData& b) {
+        return a.date < b.date;
+    });
+
+    // Po podmianie snapshotu dziennik jest już nieaktualny (inna suma kontrolna snapshotu w nagłówku),
+    // więc awaria przed jego wyczyszczeniem nie podwoi zapisów - czyszczenie tylko zwalnia miejsce
+    if (saveScoreSnapshot(snapshotFile, gameDataList)) {
+        std::ofstream(journalFile, std::ios::trunc);
+    }
+    std::cout << "Kompaktowanie: " << gameDataList.size() << " zapisów w snapshocie" << std::endl;
+}
+
+// Jednorazowa migracja: gdy nie ma jeszcze snapshotu binarnego, historia jest importowana z sscore.json
+void importLegacyJsonSave(const std::string& jsonFile, const std::string& snapshotFile) {
+    if (MappedFile(snapshotFile).size() > 0 || !std::ifstream(jsonFile).is_open()) {
+        return;
+    }
+    std::vector<GameData> gameDataList;
+    if (!loadScoreFromJson(jsonFile, gameDataList)) {
+        return;
+    }
+    removeLegacyDuplicates(gameDataList);
+    if (saveScoreSnapshot(snapshotFile, gameDataList)) {
+        std::cout << "Zaimportowano " << gameDataList.size() << " zapisów z " << jsonFile << std::endl;
+    }
+}
+
+// Mały plik indeksu aktualizowany przy każdym zapisie
+// Pozwala odczytać ostatni zapis i najlepsze wyniki bez przeglądania historii
+const std::string scoreIndexFile = "sscore.idx";
+const std::uint32_t saveIndexVersion = 2;
+const std::size_t indexTopScoreCount = 10;
+
+struct SaveIndexFile {
+    char magic[4];                              // "SGIX"
+    std::uint32_t version;
+    std::uint64_t recordCount;                  // Liczba rekordów w snapshocie i dzienniku razem
+    std::uint32_t sortedByDate;                 // 1 gdy rekordy są ułożone rosnąco według daty
+    std::uint32_t topCount;                     // Liczba zajętych pozycji w top
+    SaveRecord latest;                          // Najnowszy rekord według daty
+    SaveRecord top[indexTopScoreCount];         // Najlepsze wyniki, malejąco
+};
+
+// Dostęp do zapisów przez indeks; historia jest czytana tylko przy zapytaniu o zakres dat
+// Obiekt nie jest współdzielony między wątkami - używa go wyłącznie wątek zapisów
+class ScoreStore {
+private:
+    std::string snapshotFile;
+    std::string journalFile;
+    std::string indexFile;
+    SaveIndexFile index = {};
+    bool indexLoaded = false;
+
+    // Liczba rekordów na dysku (nagłówek snapshotu + rozmiar dziennika), bez czytania rekordów
+    std::uint64_t countRecordsOnDisk() const {
+        MappedFile snapshot(snapshotFile);
+        MappedFile journal(journalFile);
+        return snapshotRecords(snapshot).count + journalRecords(journal, snapshot).count;
+    }
+
+    // Dołączenie rekordu do indeksu w pamięci
+    void addToIndex(const SaveRecord& record) {
+        // Rekord starszy od dotychczas najnowszego psuje kolejność, ale nie zmienia najnowszego
+        if (index.recordCount > 0 && record.date < index.latest.date) {
+            index.sortedByDate = 0;
+        } else {
+            index.latest = record;
+        }
+        ++index.recordCount;
+
+        // Wstawienie do listy najlepszych wyników (przy remisie wygrywa starszy zapis)
+        std::size_t position = index.topCount;
+        while (position > 0 && index.top[position - 1].score < record.score) {
+            --position;
+        }
+        if (position >= indexTopScoreCount) {
+            return;
+        }
+        std::size_t last = std::min<std::size_t>(index.topCount, indexTopScoreCount - 1);
+        for (std::size_t i = last; i > position; --i) {
+            index.top[i] = index.top[i - 1];
+        }
+        index.top[position] = record;
+        index.topCount = static_cast<std::uint32_t>(std::min<std::size_t>(index.topCount + 1, indexTopScoreCount));
+    }
+
+    // Odbudowa indeksu jednym przejściem po zmapowanych rekordach
+    void rebuildIndex() {
+        index = {};
+        std::memcpy(index.magic, "SGIX", 4);
+        index.version = saveIndexVersion;
+        index.sortedByDate = 1;
+
+        forEachRecord([this](const SaveRecord& record) { addToIndex(record); });
+        writeIndex();
+    }
+
+    void writeIndex() const {
+        std::string contents(reinterpret_cast<const char*>(&index), sizeof(index));
+        if (!writeFileAtomically(indexFile, contents)) {
+            std::cerr << "Nie udało się zapisać indeksu " << indexFile << std::endl;
+        }
+    }
+
+    // Wczytanie indeksu z dysku; przy braku lub niezgodności z danymi - odbudowa
+    void ensureIndex() {
+        if (indexLoaded) {
+            return;
+        }
+        indexLoaded = true;
+
+        MappedFile file(indexFile);
+        if (file.size() == sizeof(SaveIndexFile)) {
+            std::memcpy(&index, file.data(), sizeof(index));
+            if (std::memcmp(index.magic, "SGIX", 4) == 0 && index.version == saveIndexVersion &&
+                index.topCount <= indexTopScoreCount && index.recordCount == countRecordsOnDisk()) {
+                return;
+            }
+        }
+        rebuildIndex();
+    }
+
+    // Przejście po wszystkich rekordach (snapshot, potem dziennik) bez budowania wektora
+    template <typename Visitor>
+    void forEachRecord(Visitor visit) const {
+        MappedFile snapshot(snapshotFile);
+        const SaveRecordSpan snapshotSpan = snapshotRecords(snapshot);
+        for (std::size_t i = 0; i < snapshotSpan.count; ++i) {
+            visit(snapshotSpan.record(i));
         }
-        inputFile.close();
+
+        MappedFile journal(journalFile);
+        const SaveRecordSpan journalSpan = journalRecords(journal, snapshot);
+        for (std::size_t i = 0; i < journalSpan.count; ++i) {
+            visit(journalSpan.record(i));
+        }
+    }
+
+    // Pierwszy rekord z datą >= date w posortowanej tablicy rekordów
+    static std::size_t lowerBoundByDate(const SaveRecordSpan& records, std::int64_t date) {
+        std::size_t low = 0;
+        std::size_t high = records.count;
+        while (low < high) {
+            std::size_t middle = low + (high - low) / 2;
+            std::int64_t middleDate;
+            std::memcpy(&middleDate, records.at(middle) + offsetof(SaveRecord, date), sizeof(middleDate));
+            if (middleDate < date) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    // Rekordy z przedziału [from, to] z jednej posortowanej tablicy
+    static void collectDateRange(const SaveRecordSpan& records, std::int64_t from, std::int64_t to, std::vector<GameData>& result) {
+        for (std::size_t i = lowerBoundByDate(records, from); i < records.count; ++i) {
+            GameData gameData = fromSaveRecord(records.record(i));
+            if (gameData.date > to) {
+                break;
+            }
+            result.push_back(gameData);
+        }
+    }
+
+public:
+    ScoreStore(const std::string& snapshot, const std::string& journal, const std::string& indexPath)
+        : snapshotFile(snapshot), journalFile(journal), indexFile(indexPath) {}
+
+    // Dopisanie zapisu do dziennika i aktualizacja indeksu
+    bool append(const GameData& gameData) {
+        ensureIndex();
+        if (!appendScoreToJournal(snapshotFile, journalFile, gameData)) {
+            return false;
+        }
+        addToIndex(toSaveRecord(gameData));
+        writeIndex();
+        return true;
+    }
+
+    // Najnowszy zapis według daty - odczyt z indeksu, czas stały niezależnie od długości historii
+    bool latest(GameData& gameData) {
+        ensureIndex();
+        if (index.recordCount == 0) {
+            return false;
+        }
+        gameData = fromSaveRecord(index.latest);
+        return true;
+    }
+
+    // Najlepsze wyniki, malejąco (przy remisie wcześniejszy zapis)
+    // Do indexTopScoreCount wyników - z indeksu; więcej wymaga przejścia po całej historii
+    std::vector<GameData> topScores(std::size_t count) {
+        ensureIndex();
+        std::vector<GameData> result;
+        if (count <= indexTopScoreCount || index.recordCount <= index.topCount) {
+            count = std::min<std::size_t>(count, index.topCount);
+            for (std::size_t i = 0; i < count; ++i) {
+                result.push_back(fromSaveRecord(index.top[i]));
+            }
+            return result;
+        }
+
+        std::vector<SaveRecord> records;
+        records.reserve(static_cast<std::size_t>(index.recordCount));
+        forEachRecord([&](const SaveRecord& record) { records.push_back(record); });
+        std::stable_sort(records.begin(), records.end(),
+                         [](const SaveRecord& a, const SaveRecord& b) { return a.score > b.score; });
+        count = std::min(count, records.size());
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            result.push_back(fromSaveRecord(records[i]));
+        }
+        return result;
+    }
+
+    // Zapisy z przedziału dat [from, to]
+    // Gdy historia jest posortowana, wystarczy wyszukiwanie binarne po zmapowanych plikach
+    std::vector<GameData> inDateRange(std::int64_t from, std::int64_t to) {
+        ensureIndex();
+        std::vector<GameData> result;
+        if (index.sortedByDate) {
+            MappedFile snapshot(snapshotFile);
+            collectDateRange(snapshotRecords(snapshot), from, to, result);
+
+            MappedFile journal(journalFile);
+            collectDateRange(journalRecords(journal, snapshot), from, to, result);
+        } else {
+            forEachRecord([&](const SaveRecord& record) {
+                if (record.date >= from && record.date <= to) {
+                    result.push_back(fromSaveRecord(record));
+                }
+            });
+        }
+        return result;
+    }
+
+    // Kompaktowanie dziennika; po nim rekordy są posortowane według daty, więc indeks jest budowany od nowa
+    void compact() {
+        compactScoreJournal(snapshotFile, journalFile);
+        rebuildIndex();
+        indexLoaded = true;
+    }
+};
+
+// Kolejka jednego producenta i jednego konsumenta bez blokad (pierścień o stałej pojemności)
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+private:
+    std::array<T, Capacity> buffer;
+    alignas(64) std::atomic<std::size_t> head{0};  // Następny element do odczytu (konsument)
+    alignas(64) std::atomic<std::size_t> tail{0};  // Następne wolne miejsce (producent)
+
+public:
+    // Wstawienie elementu; false gdy kolejka jest pełna
+    bool push(T&& item) {
+        const std::size_t currentTail = tail.load(std::memory_order_relaxed);
+        const std::size_t nextTail = (currentTail + 1) % Capacity;
+        if (nextTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        buffer[currentTail] = std::move(item);
+        tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    // Pobranie elementu; false gdy kolejka jest pusta
+    bool pop(T& item) {
+        const std::size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = std::move(buffer[currentHead]);
+        head.store((currentHead + 1) % Capacity, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+// Wynik operacji na zapisach przekazywany z powrotem do wątku gry
+struct PersistenceResult {
+    bool ok = false;            // Czy operacja się powiodła
+    bool hasGameData = false;   // Czy gameData zawiera wczytany zapis
+    GameData gameData;          // Zapisany lub wczytany stan gry
+};
+
+// Serwis zapisów: operacje na plikach wykonuje osobny wątek I/O,
+// a wątek gry tylko wrzuca zlecenia do kolejki i odbiera wyniki w pollCompletions()
+class PersistenceService {
+public:
+    using Callback = std::function<void(const PersistenceResult&)>;
+
+private:
+    enum class RequestType { Save, LoadLatest };
+
+    struct Request {
+        RequestType type = RequestType::Save;
+        GameData gameData;
+        Callback onComplete;
+    };
+
+    struct Completion {
+        PersistenceResult result;
+        Callback onComplete;
+    };
+
+    static constexpr std::size_t queueCapacity = 64;
+    static constexpr int compactEveryAppends = 256;  // Co ile dopisań dziennik jest zwijany do snapshotu
+
+    std::string snapshotFile;
+    ScoreStore store;                     // Używany wyłącznie przez wątek I/O
+    SpscQueue<Request, queueCapacity> requests;      // Wątek gry -> wątek I/O
+    SpscQueue<Completion, queueCapacity> completions; // Wątek I/O -> wątek gry
+    std::atomic<bool> stopRequested{false};
+    std::mutex wakeMutex;                 // Tylko do usypiania wątku I/O, producent go nie blokuje
+    std::condition_variable wakeCondition;
+    int appendsSinceCompaction = 0;
+    int pendingCallbacks = 0;             // Zlecenia z callbackiem, których wynik nie został jeszcze odebrany (wątek gry)
+    std::thread worker;
+
+    void enqueue(Request&& request) {
+        const bool hasCallback = static_cast<bool>(request.onComplete);
+        if (!requests.push(std::move(request))) {
+            std::cerr << "Kolejka zapisów jest pełna - zlecenie pominięte" << std::endl;
+            return;
+        }
+        if (hasCallback) {
+            ++pendingCallbacks;
+        }
+        wakeCondition.notify_one();
+    }
+
+    void process(Request& request) {
+        Completion completion;
+        completion.onComplete = std::move(request.onComplete);
+
+        if (request.type == RequestType::Save) {
+            completion.result.ok = store.append(request.gameData);
+            completion.result.hasGameData = true;
+            completion.result.gameData = request.gameData;
+
+            if (++appendsSinceCompaction >= compactEveryAppends) {
+                store.compact();
+                appendsSinceCompaction = 0;
+            }
+        } else {
+            completion.result.hasGameData = store.latest(completion.result.gameData);
+            completion.result.ok = true;
+        }
+
+        if (completion.onComplete) {
+            // Pętla gry odbiera wyniki co klatkę, więc kolejka zwrotna szybko się zwalnia
+            while (!completions.push(std::move(completion)) && !stopRequested.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+
+    void run() {
+        importLegacyJsonSave(scoreJsonFile, snapshotFile);
+
+        Request request;
+        while (true) {
+            while (requests.pop(request)) {
+                process(request);
+            }
+            if (stopRequested.load()) {
+                break;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait_for(lock, std::chrono::milliseconds(20), [this] {
+                return !requests.empty() || stopRequested.load();
+            });
+        }
+    }
+
+public:
+    PersistenceService(const std::string& snapshot, const std::string& journal, const std::string& index)
+        : snapshotFile(snapshot), store(snapshot, journal, index), worker(&PersistenceService::run, this) {}
+
+    // Zatrzymanie wątku I/O po dokończeniu wszystkich zleconych zapisów
+    ~PersistenceService() {
+        stopRequested.store(true);
+        wakeCondition.notify_one();
+        worker.join();
+    }
+
+    PersistenceService(const PersistenceService&) = delete;
+    PersistenceService& operator=(const PersistenceService&) = delete;
+
+    // Zlecenie zapisu stanu gry (nie blokuje wątku gry)
+    void save(const GameData& gameData, Callback onComplete = nullptr) {
+        Request request;
+        request.type = RequestType::Save;
+        request.gameData = gameData;
+        request.onComplete = std::move(onComplete);
+        enqueue(std::move(request));
+    }
+
+    // Zlecenie wczytania ostatniego zapisu; wynik trafia do onComplete w wątku gry
+    void loadLatest(Callback onComplete) {
+        Request request;
+        request.type = RequestType::LoadLatest;
+        request.onComplete = std::move(onComplete);
+        enqueue(std::move(request));
+    }
+
+    // Wywołanie callbacków zakończonych operacji - wołane raz na klatkę z pętli gry
+    void pollCompletions() {
+        Completion completion;
+        while (completions.pop(completion)) {
+            --pendingCallbacks;
+            completion.onComplete(completion.result);
+        }
+    }
+
+    // Czy jakiś wynik jeszcze nie wrócił (pętla gry nie może wtedy usnąć w oczekiwaniu na zdarzenie)
+    bool hasPendingCallbacks() const {
+        return pendingCallbacks > 0;
+    }
+};
+
+// Licznik alokacji na stercie wykonanych przez bieżący wątek (zastąpione globalne operator new)
+// Wątek gry i wątek renderujący porównują go na początku i końcu swojej klatki - w ustalonej rozgrywce
+// różnica ma wynosić 0. Licznik jest per wątek, bo wątki tła (zapisy, loader, zadania) alokują niezależnie od klatek
+thread_local std::uint64_t heapAllocationCount = 0;
+
+void *countedAllocate(std::size_t size) {
+    ++heapAllocationCount;
+    void *memory = std::malloc(size > 0 ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *countedAllocateAligned(std::size_t size, std::size_t alignment) {
+    ++heapAllocationCount;
+    // aligned_alloc wymaga rozmiaru będącego wielokrotnością wyrównania
+    void *memory = std::aligned_alloc(alignment, (std::max(size, std::size_t(1)) + alignment - 1) / alignment * alignment);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new(std::size_t size) { return countedAllocate(size); }
+void *operator new[](std::size_t size) { return countedAllocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try { return countedAllocate(size); } catch (...) { return nullptr; }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try { return countedAllocate(size); } catch (...) { return nullptr; }
+}
+void *operator new(std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocateAligned(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+// Arena klatki: przydział przez przesunięcie wskaźnika w buforze zaalokowanym raz, zwalnianie
+// wszystkiego naraz przez reset() na początku klatki. Dla krótko żyjących kontenerów
+// (FrameVector) - nic przydzielonego z areny nie może przeżyć końca klatki
+// Każdy wątek ma własną arenę (getFrameArena); gdy bufor się skończy, przydział idzie na stertę
+class FrameArena {
+private:
+    std::unique_ptr<unsigned char[]> buffer;
+    std::size_t capacity;
+    std::size_t offset = 0;
+    std::size_t peak = 0;               // Największe zajęcie od startu
+    std::uint64_t overflowCount = 0;    // Przydziały, które nie zmieściły się w buforze
+
+    bool owns(const void *memory) const {
+        const unsigned char *bytes = static_cast<const unsigned char *>(memory);
+        return bytes >= buffer.get() && bytes < buffer.get() + capacity;
+    }
+
+public:
+    explicit FrameArena(std::size_t bytes) : buffer(new unsigned char[bytes]), capacity(bytes) {}
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t alignment) {
+        const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(buffer.get());
+        const std::size_t aligned = ((base + offset + alignment - 1) & ~(std::uintptr_t(alignment) - 1)) - base;
+        if (aligned + bytes > capacity) {
+            ++overflowCount;
+            // Przydział awaryjny ze sterty musi mieć to samo wyrównanie co przydział z areny
+            if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return ::operator new(bytes, std::align_val_t(alignment));
+            }
+            return ::operator new(bytes);
+        }
+        offset = aligned + bytes;
+        peak = std::max(peak, offset);
+        return buffer.get() + aligned;
+    }
+
+    // Pamięć z areny wraca dopiero przy reset(); zwalniany jest tylko przydział awaryjny ze sterty
+    // alignment - ten sam co w allocate(), bo wyrównany przydział wymaga wyrównanego delete
+    void deallocate(void *memory, std::size_t alignment) {
+        if (owns(memory)) {
+            return;
+        }
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(memory, std::align_val_t(alignment));
+        } else {
+            ::operator delete(memory);
+        }
+    }
+
+    void reset() {
+        offset = 0;
+    }
+
+    std::size_t getPeak() const {
+        return peak;
+    }
+
+    std::uint64_t getOverflowCount() const {
+        return overflowCount;
+    }
+};
+
+// Rozmiar areny klatki jednego wątku (raport profilera potrzebuje do 16384 * 8 bajtów)
+const std::size_t frameArenaSize = 512 * 1024;
+
+FrameArena &getFrameArena() {
+    thread_local FrameArena arena(frameArenaSize);
+    return arena;
+}
+
+// Liczba ustalonych klatek z rzędu, po której klatka nie może już alokować (bufory zdążyły urosnąć)
+const unsigned allocationWarmupFrames = 8;
+
+// Alokacje w ustalonej klatce: ostrzeżenie (raz) albo wyjątek w trybie --strict-alloc
+// Statystyki areny klatki bieżącego wątku pokazują, czy alokacje nie biorą się z przepełnionej areny
+void reportSteadyFrameAllocations(const char *threadName, std::uint64_t allocations, bool strict, bool &warningShown) {
+    const FrameArena &arena = getFrameArena();
+    const std::string message = std::to_string(allocations) + " alokacji na stercie w ustalonej klatce (" + threadName +
+                                "; arena klatki: szczyt " + std::to_string(arena.getPeak()) + " z " +
+                                std::to_string(frameArenaSize) + " B, przydziały poza areną: " +
+                                std::to_string(arena.getOverflowCount()) + ")";
+    if (strict) {
+        throw std::logic_error(message);
+    }
+    if (!warningShown) {
+        std::cerr << "Uwaga: " << message << std::endl;
+        warningShown = true;
+    }
+}
+
+// Alokator dla kontenerów standardowych korzystający z areny klatki bieżącego wątku
+template <typename T>
+class FrameAllocator {
+public:
+    using value_type = T;
+
+    FrameArena *arena;
+
+    FrameAllocator() : arena(&getFrameArena()) {}
+    explicit FrameAllocator(FrameArena &frameArena) : arena(&frameArena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(std::size_t count) {
+        return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *memory, std::size_t) {
+        arena->deallocate(memory, alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U> &other) const {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U> &other) const {
+        return arena != other.arena;
+    }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+// Fazy klatki mierzone przez profiler (kolejność jak w pętli gry)
+enum class ProfilePhase : std::uint8_t {
+    Frame,
+    Events,
+    UfoUpdate,
+    EntityUpdate,
+    UpdateTexts,
+    Draw,
+    Display,
+    FrameWait,
+    Snapshot,
+    Count
+};
+
+const char *profilePhaseName(ProfilePhase phase) {
+    static const char *const names[] = {"Klatka", "Zdarzenia", "Ufo", "Obiekty", "Teksty", "Rysowanie", "Wyswietlanie", "Oczekiwanie", "Migawka"};
+    return names[static_cast<std::size_t>(phase)];
+}
+
+// Pojedynczy pomiar: faza, początek i czas trwania w nanosekundach od startu profilera
+struct ProfileSample {
+    ProfilePhase phase = ProfilePhase::Frame;
+    std::uint8_t thread = 1;
+    std::int64_t start = 0;
+    std::int64_t duration = 0;
+};
+
+// Numer wątku w śladzie profilera (1 - wątek gry, 2 - wątek renderujący)
+thread_local std::uint8_t profilerThreadId = 1;
+
+// Profiler klatki: pomiary trafiają do pierścienia o stałym rozmiarze bez blokad
+// Zapisywać może kilka wątków; nowszy pomiar nadpisuje najstarszy
+class FrameProfiler {
+public:
+    static constexpr std::size_t Capacity = 16384;
+
+private:
+    // Miejsce w pierścieniu; sequence = numer pomiaru + 1, gdy zapis jest kompletny (0 w trakcie zapisu)
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<std::uint8_t> phase{0};
+        std::atomic<std::uint8_t> thread{0};
+        std::atomic<std::int64_t> start{0};
+        std::atomic<std::int64_t> duration{0};
+    };
+
+    std::array<Slot, Capacity> slots;
+    std::atomic<std::uint64_t> writeIndex{0};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+public:
+    std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void record(ProfilePhase phase, std::int64_t start, std::int64_t duration) {
+        const std::uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = slots[index % Capacity];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.phase.store(static_cast<std::uint8_t>(phase), std::memory_order_relaxed);
+        slot.thread.store(profilerThreadId, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.duration.store(duration, std::memory_order_relaxed);
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // Wywołanie visit dla zachowanych pomiarów, od najstarszego
+    // Pomiary właśnie nadpisywane przez inny wątek są pomijane
+    template <typename Visit>
+    void forEachSample(Visit visit) const {
+        const std::uint64_t end = writeIndex.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > Capacity ? end - Capacity : 0;
+        for (std::uint64_t index = begin; index < end; ++index) {
+            const Slot &slot = slots[index % Capacity];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+                continue;
+            }
+            ProfileSample sample;
+            sample.phase = static_cast<ProfilePhase>(slot.phase.load(std::memory_order_relaxed));
+            sample.thread = slot.thread.load(std::memory_order_relaxed);
+            sample.start = slot.start.load(std::memory_order_relaxed);
+            sample.duration = slot.duration.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == index + 1) {
+                visit(sample);
+            }
+        }
+    }
+
+    // Zestawienie p50/p99/max (w ms) dla każdej fazy z ostatnich pomiarów
+    // Raport jest składany w report (pojemność tekstu jest używana ponownie), a tablice czasów
+    // leżą w arenie klatki - odświeżanie nakładki profilera nie alokuje pamięci na stercie
+    void formatReport(std::string &report) const {
+        std::array<std::size_t, static_cast<std::size_t>(ProfilePhase::Count)> counts = {};
+        forEachSample([&](const ProfileSample &sample) {
+            ++counts[static_cast<std::size_t>(sample.phase)];
+        });
+        std::array<FrameVector<std::int64_t>, static_cast<std::size_t>(ProfilePhase::Count)> durations;
+        for (std::size_t phase = 0; phase < durations.size(); ++phase) {
+            durations[phase].reserve(counts[phase]);
+        }
+        forEachSample([&](const ProfileSample &sample) {
+            durations[static_cast<std::size_t>(sample.phase)].push_back(sample.duration);
+        });
+
+        char line[96];
+        std::snprintf(line, sizeof(line), "%-14s%9s%9s%9s\n", "Faza [ms]", "p50", "p99", "max");
+        report.assign(line);
+        for (std::size_t phase = 0; phase < durations.size(); ++phase) {
+            FrameVector<std::int64_t> &values = durations[phase];
+            if (values.empty()) {
+                continue;
+            }
+            auto percentile = [&](double p) {
+                std::size_t rank = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+                std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+                return static_cast<double>(values[rank]) / 1e6;
+            };
+            const double p50 = percentile(0.50);
+            const double p99 = percentile(0.99);
+            const double max = static_cast<double>(*std::max_element(values.begin(), values.end())) / 1e6;
+            std::snprintf(line, sizeof(line), "%-14s%9.3f%9.3f%9.3f\n", profilePhaseName(static_cast<ProfilePhase>(phase)), p50, p99, max);
+            report.append(line);
+        }
+    }
+
+    // Eksport zachowanych pomiarów w formacie Chrome trace (chrome://tracing, Perfetto)
+    bool exportChromeTrace(const std::string &filename) const {
+        nlohmann::json trace;
+        trace["displayTimeUnit"] = "ms";
+        trace["traceEvents"] = nlohmann::json::array();
+        forEachSample([&](const ProfileSample &sample) {
+            trace["traceEvents"].push_back({
+                {"name", profilePhaseName(sample.phase)},
+                {"ph", "X"},
+                {"ts", static_cast<double>(sample.start) / 1e3},
+                {"dur", static_cast<double>(sample.duration) / 1e3},
+                {"pid", 1},
+                {"tid", sample.thread}
+            });
+        });
+
+        if (!writeFileAtomically(filename, trace.dump())) {
+            std::cerr << "Nie udało się zapisać pliku " << filename << std::endl;
+            return false;
+        }
+        std::cout << "Profil zapisany do '" << filename << "' (" << trace["traceEvents"].size() << " pomiarów)." << std::endl;
+        return true;
+    }
+};
+
+// Plik eksportu profilu (F4)
+const std::string profileTraceFile = "sgprofile.json";
+
+// Wspólny profiler gry
+FrameProfiler &getFrameProfiler() {
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+// Pomiar czasu od konstrukcji do końca zakresu (albo do wcześniejszego stop())
+// Wyłączony pomiar (enabled = false) nie odczytuje zegara i nic nie zapisuje
+class ProfileScope {
+private:
+    ProfilePhase phase;
+    std::int64_t start = 0;
+    bool stopped;
+
+public:
+    explicit ProfileScope(ProfilePhase scopePhase, bool enabled = true) : phase(scopePhase), stopped(!enabled) {
+        if (enabled) {
+            start = getFrameProfiler().now();
+        }
+    }
+
+    ~ProfileScope() {
+        stop();
+    }
+
+    void stop() {
+        if (stopped) {
+            return;
+        }
+        stopped = true;
+        FrameProfiler &profiler = getFrameProfiler();
+        profiler.record(phase, start, profiler.now() - start);
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+// Wspólna pamięć podręczna zasobów (czcionki, tekstury, obrazy) według ścieżki pliku
+// Uchwyty są licznikami referencji: plik jest czytany z dysku raz, póki ktoś trzyma do niego uchwyt,
+// a po zwolnieniu ostatniego uchwytu zasób jest zwalniany
+class AssetCache {
+private:
+    template <typename Asset>
+    using Entries = std::map<std::string, std::weak_ptr<const Asset>>;
+
+    Entries<sf::Font> fonts;
+    Entries<sf::Texture> textures;
+    Entries<sf::Image> images;
+    std::mutex mutex;
+    std::size_t diskLoads = 0;
+
+    // Odczyt odbywa się poza blokadą, żeby wątki ładujące różne pliki nie czekały na siebie
+    template <typename Asset, typename Load>
+    std::shared_ptr<const Asset> acquire(Entries<Asset> &entries, const std::string &path, Load load) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = entries.find(path);
+            if (it != entries.end()) {
+                if (std::shared_ptr<const Asset> asset = it->second.lock()) {
+                    return asset;
+                }
+            }
+        }
+
+        auto asset = std::make_shared<Asset>();
+        if (!load(*asset)) {
+            throw std::runtime_error("Nie można załadować pliku " + path);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        // Inny wątek mógł w międzyczasie wczytać ten sam plik - wtedy obowiązuje jego kopia
+        std::weak_ptr<const Asset> &entry = entries[path];
+        if (std::shared_ptr<const Asset> existing = entry.lock()) {
+            return existing;
+        }
+        ++diskLoads;
+        entry = asset;
+        return asset;
+    }
+
+public:
+    std::shared_ptr<const sf::Font> getFont(const std::string &path) {
+        return acquire(fonts, path, [&](sf::Font &font) { return font.loadFromFile(path); });
+    }
+
+    // Tekstura powstaje z obrazu z pamięci podręcznej (jeśli wczytano go wcześniej w tle, nie ma odczytu z dysku)
+    // Wysyłanie na kartę graficzną - tylko z wątku renderującego
+    std::shared_ptr<const sf::Texture> getTexture(const std::string &path) {
+        return acquire(textures, path, [&](sf::Texture &texture) { return texture.loadFromImage(*getImage(path)); });
+    }
+
+    // Dekodowanie obrazu nie używa OpenGL, więc można je wykonać w dowolnym wątku
+    std::shared_ptr<const sf::Image> getImage(const std::string &path) {
+        return acquire(images, path, [&](sf::Image &image) { return image.loadFromFile(path); });
+    }
+
+    // Liczba wczytanych zasobów od startu (do sprawdzania, że nic nie jest ładowane dwa razy)
+    std::size_t getLoadCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return diskLoads;
+    }
+};
+
+// Wspólna pamięć zasobów gry
+AssetCache &getAssetCache() {
+    static AssetCache cache;
+    return cache;
+}
+
+// Pliki zasobów gry
+const std::string uiFontFile = "arial.ttf";
+const std::string backgroundFile = "space.jpg";
+const std::vector<std::string> gameSpriteFiles = {"ufo.png", "planeta.png", "kometa.png"};
+
+// Wczytywanie zasobów w tle przy starcie gry
+// Wątki robocze dekodują obrazy (sf::Image) i czcionki do wspólnej pamięci zasobów;
+// tekstury tworzy później wątek renderujący z gotowych obrazów. Loader trzyma uchwyty,
+// więc zasoby nie znikną z pamięci, zanim gra po nie sięgnie
+class AsyncAssetLoader {
+private:
+    std::vector<std::string> imageFiles;
+    std::vector<std::string> fontFiles;
+    std::vector<std::shared_ptr<const sf::Image>> images;
+    std::vector<std::shared_ptr<const sf::Font>> fonts;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextTask{0};
+    std::atomic<std::size_t> finishedTasks{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    std::size_t taskCount() const {
+        return imageFiles.size() + fontFiles.size();
+    }
+
+    void workerLoop() {
+        for (std::size_t task = nextTask++; task < taskCount(); task = nextTask++) {
+            try {
+                if (task < imageFiles.size()) {
+                    images[task] = getAssetCache().getImage(imageFiles[task]);
+                } else {
+                    const std::size_t font = task - imageFiles.size();
+                    fonts[font] = getAssetCache().getFont(fontFiles[font]);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            finishedTasks.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+public:
+    AsyncAssetLoader(std::vector<std::string> imageList, std::vector<std::string> fontList)
+        : imageFiles(std::move(imageList)),
+          fontFiles(std::move(fontList)),
+          images(imageFiles.size()),
+          fonts(fontFiles.size()) {
+        const std::size_t workerCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), taskCount());
+        for (std::size_t i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&AsyncAssetLoader::workerLoop, this);
+        }
+    }
+
+    ~AsyncAssetLoader() {
+        for (std::thread &worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    AsyncAssetLoader(const AsyncAssetLoader &) = delete;
+    AsyncAssetLoader &operator=(const AsyncAssetLoader &) = delete;
+
+    bool isDone() const {
+        return finishedTasks.load(std::memory_order_acquire) == taskCount();
+    }
+
+    // Postęp w zakresie 0..1 (do paska na ekranie ładowania)
+    float getProgress() const {
+        return taskCount() == 0 ? 1.f : static_cast<float>(finishedTasks.load(std::memory_order_acquire)) / static_cast<float>(taskCount());
+    }
+
+    // Oczekiwanie na koniec pracy wątków; błąd któregokolwiek z nich jest rzucany tutaj
+    void wait() {
+        for (std::thread &worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Czcionka bitmapowa: glify arial.ttf wypalone przy starcie dla stałych rozmiarów do jednej tekstury
+// Dzięki temu cały tekst interfejsu trafia do jednej partii wierzchołków (TextBatch)
+class BitmapFont {
+private:
+    static constexpr std::size_t GlyphCount = 128;  // Tylko ASCII - teksty gry nie używają innych znaków
+    static constexpr unsigned Padding = 1;          // Margines wokół glifu, jak w sf::Text
+
+    struct SizeGlyphs {
+        std::array<sf::Glyph, GlyphCount> glyphs;
+        std::array<bool, GlyphCount> baked{};
+        float lineSpacing = 0.f;
+    };
+
+    std::shared_ptr<const sf::Font> font;  // Potrzebna jeszcze do odstępów między parami liter
+    std::map<unsigned, SizeGlyphs> sizes;
+    sf::Texture texture;
+
+    const SizeGlyphs &sizeGlyphs(unsigned characterSize) const {
+        auto it = sizes.find(characterSize);
+        if (it == sizes.end()) {
+            throw std::runtime_error("Rozmiar czcionki " + std::to_string(characterSize) + " nie został przygotowany");
+        }
+        return it->second;
+    }
+
+public:
+    // Wypalenie znaków first..last dla każdego z rozmiarów
+    // Strony glifów SFML (jedna na rozmiar) są układane jedna pod drugą w jednym obrazie
+    void bake(std::shared_ptr<const sf::Font> sourceFont, const std::vector<unsigned> &characterSizes, char first = ' ', char last = '~') {
+        font = std::move(sourceFont);
+        sizes.clear();
+
+        std::vector<std::pair<unsigned, sf::Image>> pages;
+        unsigned atlasWidth = 1;
+        unsigned atlasHeight = 0;
+        for (unsigned characterSize : characterSizes) {
+            SizeGlyphs &entry = sizes[characterSize];
+            entry.lineSpacing = font->getLineSpacing(characterSize);
+            for (int c = first; c <= last; ++c) {
+                entry.glyphs[static_cast<std::size_t>(c)] = font->getGlyph(static_cast<sf::Uint32>(c), characterSize, false);
+                entry.baked[static_cast<std::size_t>(c)] = true;
+            }
+
+            // Strona jest kopiowana po zamówieniu wszystkich glifów, bo SFML powiększa ją w trakcie
+            sf::Image page = font->getTexture(characterSize).copyToImage();
+            for (std::size_t c = 0; c < GlyphCount; ++c) {
+                entry.glyphs[c].textureRect.top += static_cast<int>(atlasHeight);
+            }
+            atlasWidth = std::max(atlasWidth, page.getSize().x);
+            pages.emplace_back(atlasHeight, std::move(page));
+            atlasHeight += pages.back().second.getSize().y + 2 * Padding;
+        }
+
+        sf::Image atlasImage;
+        atlasImage.create(atlasWidth, std::max(atlasHeight, 1u), sf::Color::Transparent);
+        for (const auto &page : pages) {
+            atlasImage.copy(page.second, 0, page.first);
+        }
+        if (!texture.loadFromImage(atlasImage)) {
+            throw std::runtime_error("Nie można utworzyć tekstury czcionki");
+        }
+    }
+
+    // Glif znaku albo nullptr, jeśli znak nie został wypalony
+    const sf::Glyph *getGlyph(char c, unsigned characterSize) const {
+        const SizeGlyphs &entry = sizeGlyphs(characterSize);
+        const auto index = static_cast<unsigned char>(c);
+        return index < GlyphCount && entry.baked[index] ? &entry.glyphs[index] : nullptr;
+    }
+
+    float getLineSpacing(unsigned characterSize) const {
+        return sizeGlyphs(characterSize).lineSpacing;
+    }
+
+    float getKerning(char previous, char current, unsigned characterSize) const {
+        return font->getKerning(static_cast<sf::Uint32>(static_cast<unsigned char>(previous)),
+                                static_cast<sf::Uint32>(static_cast<unsigned char>(current)), characterSize);
+    }
+
+    static unsigned getPadding() {
+        return Padding;
+    }
+
+    const sf::Texture &getTexture() const {
+        return texture;
+    }
+};
+
+// Wspólna czcionka interfejsu w rozmiarach używanych przez HUD, nakładkę profilera i ekrany
+BitmapFont &getUiFont() {
+    static BitmapFont uiFont = [] {
+        BitmapFont baked;
+        baked.bake(getAssetCache().getFont(uiFontFile), {14, 20, 30, 50});
+        return baked;
+    }();
+    return uiFont;
+}
+
+// Tekst rysowany czcionką bitmapową; interfejs jak w sf::Text
+// Geometria (w układzie tekstu) jest przebudowywana tylko po zmianie napisu, rozmiaru lub koloru
+class BitmapText {
+private:
+    const BitmapFont *font = nullptr;
+    std::string string;
+    unsigned characterSize = 30;
+    sf::Color color = sf::Color::White;
+    sf::Vector2f position;
+    mutable std::vector<sf::Vertex> vertices;
+    mutable sf::FloatRect bounds;
+    mutable bool geometryDirty = true;
+
+    // Układ glifów jak w sf::Text: linia bazowa na wysokości characterSize, '\n' przesuwa o odstęp między wierszami
+    void ensureGeometry() const {
+        if (!geometryDirty) {
+            return;
+        }
+        geometryDirty = false;
+        vertices.clear();
+        bounds = sf::FloatRect();
+        if (!font || string.empty()) {
+            return;
+        }
+
+        const float padding = static_cast<float>(BitmapFont::getPadding());
+        const sf::Glyph *space = font->getGlyph(' ', characterSize);
+        const float whitespaceWidth = space ? space->advance : 0.f;
+        const float lineSpacing = font->getLineSpacing(characterSize);
+        float x = 0.f;
+        float y = static_cast<float>(characterSize);
+        float minX = static_cast<float>(characterSize);
+        float minY = static_cast<float>(characterSize);
+        float maxX = 0.f;
+        float maxY = 0.f;
+        char previous = 0;
+
+        for (char c : string) {
+            if (c == '\r') {
+                continue;
+            }
+            x += font->getKerning(previous, c, characterSize);
+            previous = c;
+
+            if (c == ' ' || c == '\t' || c == '\n') {
+                minX = std::min(minX, x);
+                minY = std::min(minY, y);
+                if (c == ' ') {
+                    x += whitespaceWidth;
+                } else if (c == '\t') {
+                    x += whitespaceWidth * 4;
+                } else {
+                    y += lineSpacing;
+                    x = 0.f;
+                }
+                maxX = std::max(maxX, x);
+                maxY = std::max(maxY, y);
+                continue;
+            }
+
+            const sf::Glyph *glyph = font->getGlyph(c, characterSize);
+            if (!glyph) {
+                continue;
+            }
+            const float left = glyph->bounds.left - padding;
+            const float top = glyph->bounds.top - padding;
+            const float right = glyph->bounds.left + glyph->bounds.width + padding;
+            const float bottom = glyph->bounds.top + glyph->bounds.height + padding;
+            const float u1 = static_cast<float>(glyph->textureRect.left) - padding;
+            const float v1 = static_cast<float>(glyph->textureRect.top) - padding;
+            const float u2 = static_cast<float>(glyph->textureRect.left + glyph->textureRect.width) + padding;
+            const float v2 = static_cast<float>(glyph->textureRect.top + glyph->textureRect.height) + padding;
+
+            vertices.emplace_back(sf::Vector2f(x + left, y + top), color, sf::Vector2f(u1, v1));
+            vertices.emplace_back(sf::Vector2f(x + right, y + top), color, sf::Vector2f(u2, v1));
+            vertices.emplace_back(sf::Vector2f(x + left, y + bottom), color, sf::Vector2f(u1, v2));
+            vertices.emplace_back(sf::Vector2f(x + left, y + bottom), color, sf::Vector2f(u1, v2));
+            vertices.emplace_back(sf::Vector2f(x + right, y + top), color, sf::Vector2f(u2, v1));
+            vertices.emplace_back(sf::Vector2f(x + right, y + bottom), color, sf::Vector2f(u2, v2));
+
+            minX = std::min(minX, x + glyph->bounds.left);
+            maxX = std::max(maxX, x + glyph->bounds.left + glyph->bounds.width);
+            minY = std::min(minY, y + glyph->bounds.top);
+            maxY = std::max(maxY, y + glyph->bounds.top + glyph->bounds.height);
+            x += glyph->advance;
+        }
+        bounds = sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+    }
+
+public:
+    void setFont(const BitmapFont &newFont) {
+        font = &newFont;
+        geometryDirty = true;
+    }
+
+    // Przypisanie do istniejącego napisu nie alokuje, jeśli nowy tekst mieści się w dotychczasowym buforze
+    void setString(const char *newString) {
+        string.assign(newString);
+        geometryDirty = true;
+    }
+
+    void setString(const std::string &newString) {
+        string.assign(newString);
+        geometryDirty = true;
+    }
+
+    void setCharacterSize(unsigned size) {
+        characterSize = size;
+        geometryDirty = true;
+    }
+
+    void setFillColor(const sf::Color &newColor) {
+        color = newColor;
+        geometryDirty = true;
+    }
+
+    void setPosition(float x, float y) {
+        position = sf::Vector2f(x, y);
+    }
+
+    void setPosition(const sf::Vector2f &newPosition) {
+        position = newPosition;
+    }
+
+    const sf::Vector2f &getPosition() const {
+        return position;
+    }
+
+    sf::FloatRect getLocalBounds() const {
+        ensureGeometry();
+        return bounds;
+    }
+
+    // Wierzchołki w układzie tekstu (bez przesunięcia o pozycję), po 6 na glif
+    const std::vector<sf::Vertex> &getVertices() const {
+        ensureGeometry();
+        return vertices;
+    }
+};
+
+// Partia tekstu: wszystkie napisy jednej klatki w jednej tablicy wierzchołków i jednym wywołaniu draw
+class TextBatch {
+private:
+    sf::VertexArray vertices{sf::Triangles};
+    const sf::Texture *texture;
+
+public:
+    explicit TextBatch(const BitmapFont &font) : texture(&font.getTexture()) {}
+
+    // Opróżnienie partii (tablica zachowuje pojemność między klatkami)
+    void clear() {
+        vertices.clear();
+    }
+
+    void add(const BitmapText &text) {
+        const sf::Vector2f offset = text.getPosition();
+        for (const sf::Vertex &vertex : text.getVertices()) {
+            vertices.append(sf::Vertex(vertex.position + offset, vertex.color, vertex.texCoords));
+        }
+    }
+
+    void draw(sf::RenderTarget &target) const {
+        if (vertices.getVertexCount() > 0) {
+            target.draw(vertices, sf::RenderStates(texture));
+        }
+    }
+};
+
+// Warstwa statyczna: elementy, które się nie zmieniają, renderowane raz do sf::RenderTexture
+// Co klatkę rysowany jest tylko jeden teksturowany prostokąt; ponowne renderowanie po invalidate()
+class StaticLayer {
+private:
+    sf::RenderTexture renderTexture;
+    sf::Sprite sprite;
+    bool valid = false;
+
+public:
+    void invalidate() {
+        valid = false;
+    }
+
+    // logicalSize - rozmiar warstwy we współrzędnych gry, pixelSize - rozdzielczość tekstury (rozmiar okna)
+    // render - rysuje zawartość warstwy we współrzędnych gry
+    template <typename Render>
+    void draw(sf::RenderTarget &target, const sf::Vector2f &logicalSize, const sf::Vector2u &pixelSize, Render render) {
+        if (!valid) {
+            if (renderTexture.getSize() != pixelSize && !renderTexture.create(pixelSize.x, pixelSize.y)) {
+                throw std::runtime_error("Nie można utworzyć tekstury warstwy statycznej");
+            }
+            renderTexture.setView(sf::View(sf::FloatRect(0.f, 0.f, logicalSize.x, logicalSize.y)));
+            render(renderTexture);
+            renderTexture.display();
+
+            sprite.setTexture(renderTexture.getTexture(), true);
+            sprite.setScale(logicalSize.x / static_cast<float>(pixelSize.x), logicalSize.y / static_cast<float>(pixelSize.y));
+            valid = true;
+        }
+        target.draw(sprite);
+    }
+};
+
+// Stan interfejsu sterowany klawiszami (pomoc, pauza, profiler, wyjście)
+// Należy do wątku gry; wątek renderujący dostaje jego kopię w migawce stanu
+class InterfejsState {
+private:
+    bool showHelp = false;          // Flaga wyświetlania pomocy
+    bool showPause = false;         // Flaga pauzy
+    bool showProfiler = false;      // Flaga nakładki profilera
+    bool exitRequested = false;     // Flaga żądania wyjścia
+
+public:
+    void toggleHelp() { showHelp = !showHelp; }
+    void toggleProfiler() { showProfiler = !showProfiler; }
+    void togglePause() { showPause = !showPause; }
+    void resumeGame() { showPause = false; }
+    void requestExit() { exitRequested = true; }
+    bool isHelpVisible() const { return showHelp; }
+    bool isProfilerVisible() const { return showProfiler; }
+    bool isPauseVisible() const { return showPause; }
+    bool isExitRequested() const { return exitRequested; }
+};
+
+// Rysowana część interfejsu (należy do wątku renderującego)
+class Interfejs {
+private:
+    BitmapText gameOverText;          // Tekst "Game Over"
+    bool isGameOver = false;        // Flaga końca gry
+    sf::RectangleShape rectangle;   // Prostokąt obszaru gry
+    std::shared_ptr<const sf::Texture> backgroundTexture;  // Tekstura tła
+    sf::Sprite backgroundSprite;    // Sprite tła
+    BitmapText rightTopText;          // Tekst w prawym górnym rogu
+    BitmapText bottomText;          // Tekst na dole ekranu
+    BitmapText scoreText;           // Tekst wyniku
+    BitmapText helpText;            // Tekst pomocy
+    BitmapText pauseText;           // Tekst pauzy
+    BitmapText profilerText;          // Nakładka profilera
+    InterfejsState overlays;        // Które nakładki są widoczne
+    StaticLayer staticLayer;        // Tło, ramka i dolny pasek wyrenderowane raz
+    sf::Color backgroundColor = sf::Color::Black;  // Kolor tła poziomu (poza obszarem gry)
+    sf::Vector2i shownPosition{std::numeric_limits<int>::min(), 0};  // Wartości aktualnie widoczne w HUD
+    int shownScore = std::numeric_limits<int>::min();
+    sf::Vector2f size;              // Rozmiar okna
+
+    // Inicjalizacja komponentów interfejsu
+    void init() {
+        // Konfiguracja tekstu w prawym górnym rogu
+        rightTopText.setFont(getUiFont());
+        rightTopText.setCharacterSize(20);
+        rightTopText.setFillColor(sf::Color::Yellow);
+        rightTopText.setPosition(size.x - 200, 5);
+
+        // Konfiguracja tekstu na dole
+        bottomText.setFont(getUiFont());
+        bottomText.setString("---------------Pomoc F1-------------------------------------------------------------------------------------------------------------------------------------------Menu M---------------");
+        bottomText.setCharacterSize(20);
+        bottomText.setFillColor(sf::Color::Yellow);
+        bottomText.setPosition(10, size.y - bottomText.getLocalBounds().height - 20);
+
+        // Konfiguracja tekstu wyniku
+        scoreText.setFont(getUiFont());
+        scoreText.setCharacterSize(20);
+        scoreText.setFillColor(sf::Color::Yellow);
+        scoreText.setPosition(10, 5);
+
+        // Konfiguracja prostokąta obszaru gry
+        const sf::FloatRect centralBounds = getCentralBounds(size);
+        rectangle.setSize(sf::Vector2f(centralBounds.width, centralBounds.height));
+        rectangle.setPosition(centralBounds.left, centralBounds.top);
+        rectangle.setFillColor(sf::Color::Transparent);
+        rectangle.setOutlineThickness(1.f);
+        rectangle.setOutlineColor(sf::Color::White);
+
+        // Ładowanie i konfiguracja tła
+        backgroundTexture = getAssetCache().getTexture(backgroundFile);
+
+        backgroundSprite.setTexture(*backgroundTexture);
+        sf::Vector2f scale(
+            rectangle.getSize().x / backgroundTexture->getSize().x,
+            rectangle.getSize().y / backgroundTexture->getSize().y
+        );
+        backgroundSprite.setScale(scale);
+        backgroundSprite.setPosition(rectangle.getPosition());
+
+        // Konfiguracja tekstu pomocy
+        helpText.setFont(getUiFont());
+        helpText.setString("Menu kliknij M\n\nAby wznowic rozgrywke prosze nacisnac F1\n\nAby zakonczyc gre prosze nacisnac ECS");
+        helpText.setCharacterSize(30);
+        helpText.setFillColor(sf::Color::White);
+
+        // Konfiguracja tekstu pauzy
+        pauseText.setFont(getUiFont());
+        pauseText.setString("\n\n\n\n\n\n\n\n\nWcisnij ESC aby napewno zakonczyc rozgrywke\n\n Aby kontynuowac rozgrywke wcisnij Shift");
+        pauseText.setCharacterSize(30);
+        pauseText.setFillColor(sf::Color::Red);
+
+        // Konfiguracja nakładki profilera
+        profilerText.setFont(getUiFont());
+        profilerText.setCharacterSize(14);
+        profilerText.setFillColor(sf::Color::Green);
+        profilerText.setPosition(10, 60);
+        
+        centerText(helpText);
+        centerText(pauseText);
+    }
+
+    // Dopisanie napisu/liczby do bufora [cursor, end); zwraca koniec zapisanego tekstu
+    // (bufory w HUD są dobrane tak, żeby zmieścić najdłuższą liczbę int)
+    static char *appendText(char *cursor, char *end, const char *text) {
+        const std::size_t length = std::min(std::strlen(text), static_cast<std::size_t>(end - cursor));
+        std::memcpy(cursor, text, length);
+        return cursor + length;
+    }
+
+    static char *appendInt(char *cursor, char *end, int value) {
+        const std::to_chars_result result = std::to_chars(cursor, end, value);
+        return result.ec == std::errc() ? result.ptr : cursor;
+    }
+
+    void updateScoreText(int score) {
+        if (score == shownScore) {
+            return;
+        }
+        char buffer[32];
+        char *const end = buffer + sizeof(buffer) - 1;
+        char *cursor = appendText(buffer, end, "Punkty: ");
+        cursor = appendInt(cursor, end, score);
+        *cursor = '\0';
+        scoreText.setString(buffer);
+        shownScore = score;
+    }
+
+    // centrowanie tekstu na ekranie
+    void centerText(BitmapText &text) {
+        sf::FloatRect textBounds = text.getLocalBounds();
+        text.setPosition((size.x - textBounds.width) / 2, (size.y - textBounds.height) / 2);
+    }
+
+public:
+    // Konstruktor
+    Interfejs(const sf::Vector2f &windowSize) : size(windowSize) {
+        init();
+    }
+
+    // Aktualizacja tekstów w interfejsie
+    // Wywoływana co klatkę: tekst (i geometria glifów w SFML) jest przebudowywany tylko,
+    // gdy zmieniła się wyświetlana liczba całkowita; formatowanie do bufora na stosie
+    void updateTexts(const sf::Vector2f &position, int score) {
+        const sf::Vector2i displayed(static_cast<int>(position.x), static_cast<int>(position.y));
+        if (displayed != shownPosition) {
+            char buffer[48];
+            char *const end = buffer + sizeof(buffer) - 1;  // Miejsce na kończące zero
+            char *cursor = appendText(buffer, end, "Pozycja: (");
+            cursor = appendInt(cursor, end, displayed.x);
+            cursor = appendText(cursor, end, ", ");
+            cursor = appendInt(cursor, end, displayed.y);
+            cursor = appendText(cursor, end, ")");
+            *cursor = '\0';
+            rightTopText.setString(buffer);
+            shownPosition = displayed;
+        }
+        updateScoreText(score);
+    }
+
+    // Aktualizacja zestawienia profilera
+    void setProfilerReport(const std::string &report) {
+        profilerText.setString(report);
+    }
+
+    // Pokazanie tekstu końca gry
+    void showGameOver() {
+        gameOverText.setString("Game Over");
+        centerText(gameOverText);
+    }
+
+    // Widoczność nakładek według stanu z wątku gry
+    void setOverlays(const InterfejsState &state) {
+        overlays = state;
+    }
+
+    // Obszar gry: cała szerokość okna, po 50 pikseli wolnego miejsca na górze i na dole
+    // (statyczna, bo wątek gry potrzebuje jej bez tworzenia elementów graficznych)
+    static sf::FloatRect getCentralBounds(const sf::Vector2f &windowSize) {
+        return sf::FloatRect(0.f, 50.f, windowSize.x, windowSize.y - 100);
+    }
+
+    // Kolor tła poziomu; zmiana unieważnia warstwę statyczną
+    void setBackgroundColor(const sf::Color &color) {
+        if (color != backgroundColor) {
+            backgroundColor = color;
+            staticLayer.invalidate();
+        }
+    }
+
+    // Po zmianie rozmiaru okna warstwa statyczna jest renderowana w nowej rozdzielczości
+    void invalidateStaticLayer() {
+        staticLayer.invalidate();
+    }
+
+    // Rysowanie tła, ramki obszaru gry i dolnego paska z warstwy statycznej
+    void drawBackground(sf::RenderWindow &window) {
+        staticLayer.draw(window, size, window.getSize(), [&](sf::RenderTarget &target) {
+            target.clear(backgroundColor);
+            target.draw(backgroundSprite);
+            target.draw(rectangle);
+            TextBatch staticText(getUiFont());
+            staticText.add(bottomText);
+            staticText.draw(target);
+        });
+    }
+
+    // Dodanie zmiennych tekstów interfejsu do wspólnej partii tekstu (rysowanej nad sprite'ami)
+    void addText(TextBatch &textBatch) const {
+        textBatch.add(rightTopText);
+        textBatch.add(scoreText);
+
+        if (isGameOver) {
+            textBatch.add(gameOverText);
+        }
+        if (overlays.isHelpVisible()) {
+            textBatch.add(helpText);
+        }
+        if (overlays.isPauseVisible()) {
+            textBatch.add(pauseText);
+        }
+        if (overlays.isProfilerVisible()) {
+            textBatch.add(profilerText);
+        }
+    }
+};
+
+
+// Grupowanie sprite'ów według tekstury: wszystkie prostokąty z tą samą teksturą
+// trafiają do jednej tablicy wierzchołków i są rysowane jednym wywołaniem draw
+// Partie rysowane są w kolejności pierwszego użycia tekstury
+class SpriteBatch {
+private:
+    struct Batch {
+        const sf::Texture *texture = nullptr;
+        sf::VertexArray vertices{sf::Triangles};
+    };
+
+    std::vector<Batch> batches;
+    std::size_t activeBatches = 0;  // Partie zużyte w bieżącej klatce (reszta czeka z zachowaną pamięcią)
+
+    Batch &batchFor(const sf::Texture &texture) {
+        for (std::size_t i = 0; i < activeBatches; ++i) {
+            if (batches[i].texture == &texture) {
+                return batches[i];
+            }
+        }
+        if (activeBatches == batches.size()) {
+            batches.emplace_back();
+        }
+        Batch &batch = batches[activeBatches++];
+        batch.texture = &texture;
+        return batch;
+    }
+
+public:
+    // Wyczyszczenie partii przed nową klatką (bez zwalniania pamięci wierzchołków)
+    void clear() {
+        for (std::size_t i = 0; i < activeBatches; ++i) {
+            batches[i].vertices.clear();
+        }
+        activeBatches = 0;
+    }
+
+    // Dodanie prostokąta rect z fragmentem tekstury textureRect (dwa trójkąty)
+    void add(const sf::Texture &texture, const sf::FloatRect &rect, const sf::IntRect &textureRect) {
+        sf::VertexArray &vertices = batchFor(texture).vertices;
+        const float left = static_cast<float>(textureRect.left);
+        const float top = static_cast<float>(textureRect.top);
+        const float right = left + static_cast<float>(textureRect.width);
+        const float bottom = top + static_cast<float>(textureRect.height);
+
+        const sf::Vertex topLeft(sf::Vector2f(rect.left, rect.top), sf::Vector2f(left, top));
+        const sf::Vertex topRight(sf::Vector2f(rect.left + rect.width, rect.top), sf::Vector2f(right, top));
+        const sf::Vertex bottomRight(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), sf::Vector2f(right, bottom));
+        const sf::Vertex bottomLeft(sf::Vector2f(rect.left, rect.top + rect.height), sf::Vector2f(left, bottom));
+
+        vertices.append(topLeft);
+        vertices.append(topRight);
+        vertices.append(bottomRight);
+        vertices.append(topLeft);
+        vertices.append(bottomRight);
+        vertices.append(bottomLeft);
+    }
+
+    // Rysowanie: jedno wywołanie draw na teksturę, niezależnie od liczby obiektów
+    void draw(sf::RenderTarget &target) const {
+        for (std::size_t i = 0; i < activeBatches; ++i) {
+            target.draw(batches[i].vertices, sf::RenderStates(batches[i].texture));
+        }
+    }
+
+    std::size_t getDrawCallCount() const {
+        return activeBatches;
+    }
+};
+
+// Atlas tekstur: wszystkie sprite'y rozgrywki w jednej teksturze
+// Dzięki temu UFO, przeszkody i nagrody trafiają do jednej partii SpriteBatch bez przełączania tekstur
+class TextureAtlas {
+private:
+    sf::Texture texture;
+    std::map<std::string, sf::IntRect> regions;  // Nazwa pliku -> fragment atlasu
+
+public:
+    // Pakowanie półkowe: obrazy posortowane malejąco według wysokości układane w wiersze o szerokości maxWidth
+    // padding - odstęp między obrazami, żeby filtrowanie nie zaciągało pikseli sąsiada
+    void build(const std::vector<std::string> &files, unsigned maxWidth = 1024, unsigned padding = 1) {
+        // Obrazy źródłowe są potrzebne tylko do złożenia atlasu; uchwyty znikają po wyjściu z build()
+        std::vector<std::pair<std::string, std::shared_ptr<const sf::Image>>> images(files.size());
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            images[i].first = files[i];
+            images[i].second = getAssetCache().getImage(files[i]);
+        }
+        std::stable_sort(images.begin(), images.end(), [](const auto &a, const auto &b) {
+            return a.second->getSize().y > b.second->getSize().y;
+        });
+
+        // Rozmieszczenie obrazów w wierszach
+        unsigned cursorX = padding;
+        unsigned cursorY = padding;
+        unsigned rowHeight = 0;
+        unsigned atlasWidth = 0;
+        regions.clear();
+        for (const auto &image : images) {
+            const sf::Vector2u size = image.second->getSize();
+            if (cursorX + size.x + padding > maxWidth && cursorX > padding) {
+                cursorX = padding;
+                cursorY += rowHeight + padding;
+                rowHeight = 0;
+            }
+            regions[image.first] = sf::IntRect(static_cast<int>(cursorX), static_cast<int>(cursorY),
+                                               static_cast<int>(size.x), static_cast<int>(size.y));
+            cursorX += size.x + padding;
+            rowHeight = std::max(rowHeight, size.y);
+            atlasWidth = std::max(atlasWidth, cursorX);
+        }
+
+        // Skopiowanie pikseli do jednego obrazu i wysłanie go na kartę graficzną
+        sf::Image atlasImage;
+        atlasImage.create(std::max(atlasWidth, 1u), cursorY + rowHeight + padding, sf::Color::Transparent);
+        for (const auto &image : images) {
+            const sf::IntRect &region = regions[image.first];
+            atlasImage.copy(*image.second, static_cast<unsigned>(region.left), static_cast<unsigned>(region.top));
+        }
+        if (!texture.loadFromImage(atlasImage)) {
+            throw std::runtime_error("Nie można utworzyć tekstury atlasu");
+        }
+    }
+
+    const sf::Texture &getTexture() const {
+        return texture;
+    }
+
+    // Fragment atlasu zajmowany przez dany plik
+    const sf::IntRect &getRegion(const std::string &file) const {
+        auto it = regions.find(file);
+        if (it == regions.end()) {
+            throw std::runtime_error("Brak " + file + " w atlasie tekstur");
+        }
+        return it->second;
+    }
+};
+
+// Wspólny atlas sprite'ów gry, budowany przy pierwszym użyciu - tylko w wątku renderującym (tworzy teksturę)
+TextureAtlas &getGameAtlas() {
+    static TextureAtlas atlas = [] {
+        TextureAtlas built;
+        built.build(gameSpriteFiles);
+        return built;
+    }();
+    return atlas;
+}
+
+// Rozmiar sprite'a odczytany z obrazu zdekodowanego przez loader zasobów, bez sięgania po atlas,
+// więc wątek gry zna rozmiary obiektów, zanim wątek renderujący zbuduje teksturę
+sf::Vector2f getSpriteImageSize(const std::string &file) {
+    const sf::Vector2u size = getAssetCache().getImage(file)->getSize();
+    return sf::Vector2f(static_cast<float>(size.x), static_cast<float>(size.y));
+}
+
+// Stan klawiszy sterujących w jednym kroku symulacji (bity InputKey)
+// Symulacja nie czyta klawiatury sama, więc można ją karmić wejściem ze skryptu
+enum InputKey : std::uint8_t {
+    InputLeft = 1 << 0,
+    InputRight = 1 << 1,
+    InputUp = 1 << 2,
+    InputDown = 1 << 3
+};
+
+struct InputState {
+    std::uint8_t keys = 0;
+
+    bool isPressed(InputKey key) const {
+        return (keys & key) != 0;
+    }
+};
+
+// Odczyt strzałek z klawiatury
+InputState readKeyboardInput() {
+    InputState input;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
+        input.keys |= InputLeft;
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+        input.keys |= InputRight;
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
+        input.keys |= InputUp;
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
+        input.keys |= InputDown;
+    }
+    return input;
+}
+
+// Klasa UFO
+class Ufo {
+private:
+    sf::Vector2f position;
+    sf::Vector2f previousPosition;  // Pozycja z poprzedniego kroku symulacji (do interpolacji)
+    sf::Vector2f size;              // Rozmiar prostokąta ograniczającego
+    float speed = 200.f;
+
+public:
+    // Konstruktor
+    Ufo(float x_in, float y_in, const sf::Vector2f &ufoSize) : size(ufoSize) {
+        position.x = x_in;
+        position.y = y_in;
+        previousPosition = position;
+    }
+
+    static constexpr const char *spriteFile = "ufo.png";
+
+    // Fragment atlasu z grafiką UFO
+    static const sf::IntRect &getRegion() {
+        static const sf::IntRect region = getGameAtlas().getRegion(spriteFile);
+        return region;
+    }
+
+    // Rozmiar UFO na ekranie
+    static sf::Vector2f getTextureSize() {
+        return sf::Vector2f(static_cast<float>(getRegion().width), static_cast<float>(getRegion().height));
+    }
+
+    // Metoda aktualizująca pozycję UFO
+    void update(float deltaTime, const sf::FloatRect &bounds, const InputState &input) {
+        previousPosition = position;
+
+        if (input.isPressed(InputLeft)) {
+            position.x -= speed * deltaTime;
+        }
+        if (input.isPressed(InputRight)) {
+            position.x += speed * deltaTime;
+        }
+        if (input.isPressed(InputUp)) {
+            position.y -= speed * deltaTime;
+        }
+        if (input.isPressed(InputDown)) {
+            position.y += speed * deltaTime;
+        }
+
+        // Utrzymanie w granicach ekranu
+        if (position.x < bounds.left) {
+            position.x = bounds.left;
+        }
+        if (position.x + size.x > bounds.left + bounds.width) {
+            position.x = bounds.left + bounds.width - size.x;
+        }
+        if (position.y < bounds.top) {
+            position.y = bounds.top;
+        }
+        if (position.y + size.y > bounds.top + bounds.height) {
+            position.y = bounds.top + bounds.height - size.y;
+        }
+    }
+
+    // Dodanie UFO do partii sprite'ów
+    static void draw(SpriteBatch &batch, float x, float y) {
+        const sf::Vector2f size = getTextureSize();
+        batch.add(getGameAtlas().getTexture(), sf::FloatRect(x, y, size.x, size.y), getRegion());
+    }
+
+    // Pobranie prostokąta granicznego UFO
+    sf::FloatRect getBounds() const {
+        return sf::FloatRect(position.x, position.y, size.x, size.y);
+    }
+
+    // Pobranie pozycji UFO
+    sf::Vector2f getPosition() const {
+        return position;
+    }
+
+    // Pozycja z poprzedniego kroku symulacji (do interpolacji)
+    sf::Vector2f getPreviousPosition() const {
+        return previousPosition;
+    }
+
+    // Ustawienie pozycji UFO (dla ładowania z pliku)
+    void setPosition(const sf::Vector2f &newPosition) {
+        position = newPosition;
+        previousPosition = newPosition;
+    }
+};
+
+// Klasa reprezentująca przeszkody w grze
+// Stan przeszkód (pozycje, prędkości) trzyma EntityStore; klasa odpowiada tylko za wygląd
+class Obstacle {
+public:
+    static constexpr const char *spriteFile = "planeta.png";
+
+    // Fragment atlasu z grafiką przeszkody
+    static const sf::IntRect &getRegion() {
+        static const sf::IntRect region = getGameAtlas().getRegion(spriteFile);
+        return region;
+    }
+
+    // Rozmiar przeszkody na ekranie
+    static sf::Vector2f getSize() {
+        return sf::Vector2f(static_cast<float>(getRegion().width), static_cast<float>(getRegion().height));
+    }
+
+    // Dodanie przeszkody do partii sprite'ów - wierzchołki powstają dopiero przy rysowaniu
+    static void draw(SpriteBatch &batch, float x, float y) {
+        const sf::Vector2f size = getSize();
+        batch.add(getGameAtlas().getTexture(), sf::FloatRect(x, y, size.x, size.y), getRegion());
+    }
+};
+
+// Klasa reprezentująca nagrody w grze
+// Podobnie jak Obstacle - stan w EntityStore, tutaj tylko wygląd
+class Reward {
+public:
+    static constexpr const char *spriteFile = "kometa.png";
+
+    // Fragment atlasu z grafiką nagrody
+    static const sf::IntRect &getRegion() {
+        static const sf::IntRect region = getGameAtlas().getRegion(spriteFile);
+        return region;
+    }
+
+    // Rozmiar nagrody na ekranie
+    static sf::Vector2f getSize() {
+        return sf::Vector2f(static_cast<float>(getRegion().width), static_cast<float>(getRegion().height));
+    }
+
+    // Dodanie nagrody do partii sprite'ów
+    static void draw(SpriteBatch &batch, float x, float y) {
+        const sf::Vector2f size = getSize();
+        batch.add(getGameAtlas().getTexture(), sf::FloatRect(x, y, size.x, size.y), getRegion());
+    }
+};
+
+// Struktura przechowująca konfigurację poziomu gry
+struct Level {
+    sf::Color backgroundColor;  // Kolor tła dla danego poziomu
+    float obstacleSpeed;        // Prędkość przeszkód na tym poziomie
+    int numObstacles;          // Liczba przeszkód na poziomie
+
+    // Konstruktor poziomu inicjalizujący wszystkie parametry
+    Level(sf::Color bgColor, float speed, int obstacles)
+        : backgroundColor(bgColor), obstacleSpeed(speed), numObstacles(obstacles) {}
+};
+
+// Rodzaj obiektu w symulacji
+enum class EntityKind : std::uint8_t {
+    Obstacle,
+    Reward
+};
+
+// Obiekt zarejestrowany w świecie kolizji
+struct CollisionEntity {
+    EntityKind kind;        // Rodzaj obiektu
+    sf::FloatRect bounds;   // Prostokąt ograniczający
+};
+
+// Świat kolizji z fazą wstępną opartą o jednolitą siatkę (spatial hash)
+// Siatka jest budowana od nowa sortowaniem przez zliczanie; po reserve() nie alokuje pamięci
+// Zapytanie sprawdza tylko obiekty z komórek, które obejmuje pytany prostokąt, więc jego koszt zależy
+// od zagęszczenia obiektów, a nie od ich liczby. Komórka nie może być mniejsza niż największy obiekt
+// (każdy obiekt leży wtedy w najwyżej 4 komórkach)
+class CollisionWorld {
+private:
+    float cellSize;
+    std::vector<CollisionEntity> entities;
+    std::vector<std::uint32_t> bucketStart;         // Początek kubełka w bucketEntries (CSR)
+    std::vector<std::uint32_t> bucketEntries;       // Indeksy obiektów ułożone kubełkami
+    std::vector<std::uint32_t> bucketCursor;        // Bufor roboczy do wypełniania kubełków
+    mutable std::vector<std::uint32_t> visitStamp;  // Znacznik ostatniego zapytania, w którym obiekt był zwrócony
+    mutable std::uint32_t currentStamp = 0;
+    std::size_t bucketMask = 0;
+
+    // Liczba kubełków: potęga dwójki, co najmniej dwa razy więcej niż obiektów
+    static std::size_t bucketCountFor(std::size_t count) {
+        std::size_t bucketCount = 16;
+        while (bucketCount < count * 2) {
+            bucketCount *= 2;
+        }
+        return bucketCount;
+    }
+
+    // Zakres komórek objętych prostokątem
+    void cellRange(const sf::FloatRect& bounds, int& minX, int& minY, int& maxX, int& maxY) const {
+        minX = static_cast<int>(std::floor(bounds.left / cellSize));
+        minY = static_cast<int>(std::floor(bounds.top / cellSize));
+        maxX = static_cast<int>(std::floor((bounds.left + bounds.width) / cellSize));
+        maxY = static_cast<int>(std::floor((bounds.top + bounds.height) / cellSize));
+    }
+
+    std::size_t bucketOf(int cellX, int cellY) const {
+        std::uint32_t hash = static_cast<std::uint32_t>(cellX) * 73856093u ^ static_cast<std::uint32_t>(cellY) * 19349663u;
+        return hash & bucketMask;
+    }
+
+    // Wywołuje visit(bucket) dla każdej komórki objętej prostokątem
+    template <typename Visitor>
+    void forEachBucket(const sf::FloatRect& bounds, Visitor visit) const {
+        int minX, minY, maxX, maxY;
+        cellRange(bounds, minX, minY, maxX, maxY);
+        for (int cellY = minY; cellY <= maxY; ++cellY) {
+            for (int cellX = minX; cellX <= maxX; ++cellX) {
+                visit(bucketOf(cellX, cellY));
+            }
+        }
+    }
+
+    // Nowy znacznik zapytania (po przepełnieniu znaczniki są zerowane)
+    std::uint32_t nextStamp() const {
+        if (++currentStamp == 0) {
+            std::fill(visitStamp.begin(), visitStamp.end(), 0u);
+            currentStamp = 1;
+        }
+        return currentStamp;
+    }
+
+public:
+    explicit CollisionWorld(float cell = 64.f) : cellSize(cell) {}
+
+    // Pamięć na count obiektów - budowanie siatki z najwyżej tylu obiektów nie alokuje
+    void reserve(std::size_t count) {
+        const std::size_t bucketCount = bucketCountFor(count);
+        entities.reserve(count);
+        bucketStart.reserve(bucketCount + 1);
+        bucketEntries.reserve(count * 4);
+        bucketCursor.reserve(bucketCount);
+        visitStamp.reserve(count);
+    }
+
+    // Usunięcie wszystkich obiektów przed kolejnym budowaniem
+    void clear() {
+        entities.clear();
+    }
+
+    // Rejestracja obiektu; zwraca jego indeks w świecie
+    std::uint32_t add(EntityKind kind, const sf::FloatRect& bounds) {
+        entities.push_back({kind, bounds});
+        return static_cast<std::uint32_t>(entities.size() - 1);
+    }
+
+    // Zbudowanie siatki dla zarejestrowanych obiektów
+    void build() {
+        const std::size_t bucketCount = bucketCountFor(entities.size());
+        bucketMask = bucketCount - 1;
+        bucketStart.assign(bucketCount + 1, 0);
+
+        // Zliczenie wpisów w kubełkach, suma prefiksowa, rozłożenie indeksów
+        for (const auto& entity : entities) {
+            forEachBucket(entity.bounds, [&](std::size_t bucket) { ++bucketStart[bucket + 1]; });
+        }
+        for (std::size_t i = 0; i < bucketCount; ++i) {
+            bucketStart[i + 1] += bucketStart[i];
+        }
+        bucketEntries.resize(bucketStart[bucketCount]);
+        bucketCursor.assign(bucketStart.begin(), bucketStart.end() - 1);
+        for (std::uint32_t index = 0; index < entities.size(); ++index) {
+            forEachBucket(entities[index].bounds, [&](std::size_t bucket) { bucketEntries[bucketCursor[bucket]++] = index; });
+        }
+
+        visitStamp.assign(entities.size(), 0u);
+        currentStamp = 0;
+    }
+
+    const CollisionEntity& entity(std::uint32_t index) const {
+        return entities[index];
+    }
+
+    // Obiekty, których prostokąty przecinają area (każdy co najwyżej raz, rosnąco według indeksu)
+    // area może być prostokątem UFO albo innego obiektu - zapytania obiekt-obiekt działają tak samo
+    void query(const sf::FloatRect& area, std::vector<std::uint32_t>& result) const {
+        result.clear();
+        const std::uint32_t stamp = nextStamp();
+        forEachBucket(area, [&](std::size_t bucket) {
+            for (std::uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; ++i) {
+                const std::uint32_t index = bucketEntries[i];
+                if (visitStamp[index] != stamp && entities[index].bounds.intersects(area)) {
+                    visitStamp[index] = stamp;
+                    result.push_back(index);
+                }
+            }
+        });
+        std::sort(result.begin(), result.end());
+    }
+};
+
+// Kernel aktualizacji ruchomych obiektów: przesuwa x o velocityX * deltaTime,
+// zaznacza w wrappedMask obiekty, które wyszły za lewą krawędź, a w hitMask te, które przecinają prostokąt UFO
+// Maski to słowa 64-bitowe (bit i = obiekt i); kernel sam je zeruje
+// Warianty: skalarny (wszędzie), SSE (4 obiekty naraz) i AVX2 (8 obiektów naraz) - wybierany przy starcie
+struct EntityKernelInput {
+    float* x;
+    const float* y;
+    const float* velocityX;
+    const float* width;
+    const float* height;
+    std::size_t count;
+};
+
+using EntityKernel = void (*)(const EntityKernelInput& input, float deltaTime, float leftEdge,
+                              const sf::FloatRect& ufoBounds, std::uint64_t* wrappedMask, std::uint64_t* hitMask);
+
+std::size_t entityMaskWords(std::size_t count) {
+    return (count + 63) / 64;
+}
+
+// Jeden obiekt - wspólny dla wersji skalarnej i końcówek wersji SIMD
+inline void entityKernelStep(const EntityKernelInput& input, std::size_t i, float deltaTime, float leftEdge,
+                             const sf::FloatRect& ufoBounds, std::uint64_t* wrappedMask, std::uint64_t* hitMask) {
+    const float x = input.x[i] + input.velocityX[i] * deltaTime;
+    input.x[i] = x;
+    const float right = x + input.width[i];
+    const std::uint64_t bit = std::uint64_t(1) << (i % 64);
+    if (right < leftEdge) {
+        wrappedMask[i / 64] |= bit;
+    }
+    // Ta sama reguła co sf::Rect::intersects (ścisłe nierówności)
+    if (x < ufoBounds.left + ufoBounds.width && ufoBounds.left < right &&
+        input.y[i] < ufoBounds.top + ufoBounds.height && ufoBounds.top < input.y[i] + input.height[i]) {
+        hitMask[i / 64] |= bit;
+    }
+}
+
+void entityKernelScalar(const EntityKernelInput& input, float deltaTime, float leftEdge,
+                        const sf::FloatRect& ufoBounds, std::uint64_t* wrappedMask, std::uint64_t* hitMask) {
+    std::fill(wrappedMask, wrappedMask + entityMaskWords(input.count), 0);
+    std::fill(hitMask, hitMask + entityMaskWords(input.count), 0);
+    for (std::size_t i = 0; i < input.count; ++i) {
+        entityKernelStep(input, i, deltaTime, leftEdge, ufoBounds, wrappedMask, hitMask);
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SPACEGAME_X86_KERNELS 1
+
+void entityKernelSse(const EntityKernelInput& input, float deltaTime, float leftEdge,
+                     const sf::FloatRect& ufoBounds, std::uint64_t* wrappedMask, std::uint64_t* hitMask) {
+    std::fill(wrappedMask, wrappedMask + entityMaskWords(input.count), 0);
+    std::fill(hitMask, hitMask + entityMaskWords(input.count), 0);
+
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 edge = _mm_set1_ps(leftEdge);
+    const __m128 ufoLeft = _mm_set1_ps(ufoBounds.left);
+    const __m128 ufoRight = _mm_set1_ps(ufoBounds.left + ufoBounds.width);
+    const __m128 ufoTop = _mm_set1_ps(ufoBounds.top);
+    const __m128 ufoBottom = _mm_set1_ps(ufoBounds.top + ufoBounds.height);
+
+    std::size_t i = 0;
+    for (; i + 4 <= input.count; i += 4) {
+        __m128 x = _mm_add_ps(_mm_loadu_ps(input.x + i), _mm_mul_ps(_mm_loadu_ps(input.velocityX + i), dt));
+        _mm_storeu_ps(input.x + i, x);
+        const __m128 right = _mm_add_ps(x, _mm_loadu_ps(input.width + i));
+        const __m128 top = _mm_loadu_ps(input.y + i);
+        const __m128 bottom = _mm_add_ps(top, _mm_loadu_ps(input.height + i));
+
+        const __m128 wrapped = _mm_cmplt_ps(right, edge);
+        const __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(x, ufoRight), _mm_cmplt_ps(ufoLeft, right)),
+                                      _mm_and_ps(_mm_cmplt_ps(top, ufoBottom), _mm_cmplt_ps(ufoTop, bottom)));
+
+        const unsigned shift = static_cast<unsigned>(i % 64);
+        wrappedMask[i / 64] |= static_cast<std::uint64_t>(_mm_movemask_ps(wrapped)) << shift;
+        hitMask[i / 64] |= static_cast<std::uint64_t>(_mm_movemask_ps(hit)) << shift;
+    }
+    for (; i < input.count; ++i) {
+        entityKernelStep(input, i, deltaTime, leftEdge, ufoBounds, wrappedMask, hitMask);
+    }
+}
+
+__attribute__((target("avx2")))
+void entityKernelAvx2(const EntityKernelInput& input, float deltaTime, float leftEdge,
+                      const sf::FloatRect& ufoBounds, std::uint64_t* wrappedMask, std::uint64_t* hitMask) {
+    std::fill(wrappedMask, wrappedMask + entityMaskWords(input.count), 0);
+    std::fill(hitMask, hitMask + entityMaskWords(input.count), 0);
+
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 edge = _mm256_set1_ps(leftEdge);
+    const __m256 ufoLeft = _mm256_set1_ps(ufoBounds.left);
+    const __m256 ufoRight = _mm256_set1_ps(ufoBounds.left + ufoBounds.width);
+    const __m256 ufoTop = _mm256_set1_ps(ufoBounds.top);
+    const __m256 ufoBottom = _mm256_set1_ps(ufoBounds.top + ufoBounds.height);
+
+    std::size_t i = 0;
+    for (; i + 8 <= input.count; i += 8) {
+        // Bez FMA, żeby wynik był bit w bit taki sam jak w wersji skalarnej
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(input.x + i), _mm256_mul_ps(_mm256_loadu_ps(input.velocityX + i), dt));
+        _mm256_storeu_ps(input.x + i, x);
+        const __m256 right = _mm256_add_ps(x, _mm256_loadu_ps(input.width + i));
+        const __m256 top = _mm256_loadu_ps(input.y + i);
+        const __m256 bottom = _mm256_add_ps(top, _mm256_loadu_ps(input.height + i));
+
+        const __m256 wrapped = _mm256_cmp_ps(right, edge, _CMP_LT_OQ);
+        const __m256 hit = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(x, ufoRight, _CMP_LT_OQ), _mm256_cmp_ps(ufoLeft, right, _CMP_LT_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(top, ufoBottom, _CMP_LT_OQ), _mm256_cmp_ps(ufoTop, bottom, _CMP_LT_OQ)));
+
+        const unsigned shift = static_cast<unsigned>(i % 64);
+        wrappedMask[i / 64] |= static_cast<std::uint64_t>(_mm256_movemask_ps(wrapped)) << shift;
+        hitMask[i / 64] |= static_cast<std::uint64_t>(_mm256_movemask_ps(hit)) << shift;
+    }
+    for (; i < input.count; ++i) {
+        entityKernelStep(input, i, deltaTime, leftEdge, ufoBounds, wrappedMask, hitMask);
+    }
+}
+#endif
+
+// Wywołuje visit(i) dla każdego ustawionego bitu maski, rosnąco
+template <typename Visitor>
+void forEachSetBit(const std::vector<std::uint64_t>& mask, Visitor visit) {
+    for (std::size_t word = 0; word < mask.size(); ++word) {
+        for (std::uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+            visit(word * 64 + static_cast<std::size_t>(__builtin_ctzll(bits)));
+        }
+    }
+}
+
+// Nazwa wybranego wariantu (do logów i benchmarku)
+const char* entityKernelName(EntityKernel kernel) {
+#ifdef SPACEGAME_X86_KERNELS
+    if (kernel == entityKernelAvx2) {
+        return "AVX2";
+    }
+    if (kernel == entityKernelSse) {
+        return "SSE";
+    }
+#endif
+    (void)kernel;
+    return "skalarny";
+}
+
+// Wybór najszybszego wariantu obsługiwanego przez procesor
+EntityKernel selectEntityKernel() {
+#ifdef SPACEGAME_X86_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return entityKernelAvx2;
+    }
+    return entityKernelSse;
+#else
+    return entityKernelScalar;
+#endif
+}
+
+// Wariant wybrany raz przy starcie programu
+const EntityKernel activeEntityKernel = selectEntityKernel();
+
+// Krok splitmix64 - rozprowadza dowolne ziarno (także 0 i małe liczby) na pełny stan generatora
+std::uint64_t splitMix64(std::uint64_t &state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+inline std::uint32_t rotateLeft(std::uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Szybki deterministyczny generator liczb losowych (xoshiro128**) zamiast rand()
+// Stan ma 16 bajtów i należy do właściciela (bez globalnego stanu i blokad), a ta sama wartość
+// ziarna daje tę samą sekwencję na każdej platformie i bibliotece standardowej
+class Random {
+private:
+    std::uint32_t state[4];
+
+public:
+    explicit Random(std::uint64_t seed = 1) {
+        reseed(seed);
+    }
+
+    void reseed(std::uint64_t seed) {
+        const std::uint64_t a = splitMix64(seed);
+        const std::uint64_t b = splitMix64(seed);
+        state[0] = static_cast<std::uint32_t>(a);
+        state[1] = static_cast<std::uint32_t>(a >> 32);
+        state[2] = static_cast<std::uint32_t>(b);
+        state[3] = static_cast<std::uint32_t>(b >> 32);
+    }
+
+    // Niezależny strumień o numerze index wyprowadzony z ziarna (np. jeden na zakres zadań)
+    static Random stream(std::uint64_t seed, std::uint64_t index) {
+        std::uint64_t mixed = seed ^ (index * 0xD1B54A32D192ED03ull);
+        return Random(splitMix64(mixed));
+    }
+
+    std::uint32_t next() {
+        const std::uint32_t result = rotateLeft(state[1] * 5, 7) * 9;
+        const std::uint32_t t = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotateLeft(state[3], 11);
+        return result;
+    }
+
+    std::uint64_t next64() {
+        const std::uint64_t high = next();
+        return (high << 32) | next();
+    }
+
+    // Liczba całkowita z [0, bound) bez obciążenia modulo (metoda Lemire'a - zwykle bez dzielenia)
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t product = static_cast<std::uint64_t>(next()) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            const std::uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<std::uint64_t>(next()) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+};
+
+// Osiem niezależnych generatorów xoshiro128** ułożonych kolumnami (SoA) do masowego losowania
+// Pozycja i tablicy pochodzi z generatora i % 8, więc wersja AVX2 (8 naraz) i skalarna dają identyczny wynik
+class RandomLanes {
+public:
+    static constexpr std::size_t laneCount = 8;
+
+private:
+    alignas(32) std::uint32_t state[4][laneCount];
+
+    static float toUniform(std::uint32_t value, float low, float range) {
+        return low + static_cast<float>(value >> 8) * (1.f / 16777216.f) * range;
+    }
+
+    std::uint32_t nextLane(std::size_t lane) {
+        std::uint32_t *s0 = &state[0][lane];
+        std::uint32_t *s1 = &state[1][lane];
+        std::uint32_t *s2 = &state[2][lane];
+        std::uint32_t *s3 = &state[3][lane];
+        const std::uint32_t result = rotateLeft(*s1 * 5, 7) * 9;
+        const std::uint32_t t = *s1 << 9;
+        *s2 ^= *s0;
+        *s3 ^= *s1;
+        *s1 ^= *s2;
+        *s0 ^= *s3;
+        *s2 ^= t;
+        *s3 = rotateLeft(*s3, 11);
+        return result;
+    }
+
+    void fillBlocksScalar(float *out, std::size_t blocks, float low, float range) {
+        for (std::size_t block = 0; block < blocks; ++block) {
+            for (std::size_t lane = 0; lane < laneCount; ++lane) {
+                out[block * laneCount + lane] = toUniform(nextLane(lane), low, range);
+            }
+        }
+    }
+
+#ifdef SPACEGAME_X86_KERNELS
+    __attribute__((target("avx2")))
+    static __m256i rotateLeftAvx2(__m256i value, int bits) {
+        return _mm256_or_si256(_mm256_slli_epi32(value, bits), _mm256_srli_epi32(value, 32 - bits));
+    }
+
+    __attribute__((target("avx2")))
+    void fillBlocksAvx2(float *out, std::size_t blocks, float low, float range) {
+        __m256i s0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(state[0]));
+        __m256i s1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(state[1]));
+        __m256i s2 = _mm256_load_si256(reinterpret_cast<const __m256i *>(state[2]));
+        __m256i s3 = _mm256_load_si256(reinterpret_cast<const __m256i *>(state[3]));
+        const __m256 scale = _mm256_set1_ps(1.f / 16777216.f);
+        const __m256 lowVector = _mm256_set1_ps(low);
+        const __m256 rangeVector = _mm256_set1_ps(range);
+
+        for (std::size_t block = 0; block < blocks; ++block) {
+            // x * 5 i x * 9 jako przesunięcie i dodawanie (bez 32-bitowego mnożenia wektorowego)
+            const __m256i times5 = _mm256_add_epi32(_mm256_slli_epi32(s1, 2), s1);
+            const __m256i rotated = rotateLeftAvx2(times5, 7);
+            const __m256i result = _mm256_add_epi32(_mm256_slli_epi32(rotated, 3), rotated);
+            const __m256i t = _mm256_slli_epi32(s1, 9);
+            s2 = _mm256_xor_si256(s2, s0);
+            s3 = _mm256_xor_si256(s3, s1);
+            s1 = _mm256_xor_si256(s1, s2);
+            s0 = _mm256_xor_si256(s0, s3);
+            s2 = _mm256_xor_si256(s2, t);
+            s3 = rotateLeftAvx2(s3, 11);
+
+            // Kolejność działań jak w toUniform: (wartość * skala) * zakres + dolna granica
+            const __m256 unit = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(result, 8)), scale);
+            _mm256_storeu_ps(out + block * laneCount, _mm256_add_ps(lowVector, _mm256_mul_ps(unit, rangeVector)));
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(state[0]), s0);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(state[1]), s1);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(state[2]), s2);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(state[3]), s3);
     }
+#endif
 
-    // Konwersja danych gry do JSON
-    for (const auto& gameData : gameDataList) {
-        nlohmann::json entry;
-        entry["position"] = {gameData.position.x, gameData.position.y};
-        entry["score"] = gameData.score;
-        entry["date"] = gameData.date;
-        jsonData["games"].push_back(entry);
+public:
+    explicit RandomLanes(std::uint64_t seed) {
+        for (std::size_t lane = 0; lane < laneCount; ++lane) {
+            Random laneSeed = Random::stream(seed, lane);
+            for (std::size_t word = 0; word < 4; ++word) {
+                state[word][lane] = laneSeed.next();
+            }
+        }
     }
 
-    // Zapis do pliku
-    std::ofstream outputFile(filename, std::ios::trunc);
-    if (!outputFile.is_open()) {
-        std::cerr << "Nie można otworzyć pliku do zapisu!" << std::endl;
-        return;
+    // Wypełnienie out[0..count) liczbami z [low, high)
+    // useSimd = false wymusza wersję skalarną (porównanie wyników w testach wydajności)
+    void fillUniform(float *out, std::size_t count, float low, float high, bool useSimd = true) {
+        const float range = high - low;
+        const std::size_t blocks = count / laneCount;
+#ifdef SPACEGAME_X86_KERNELS
+        static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+        if (useSimd && hasAvx2) {
+            fillBlocksAvx2(out, blocks, low, range);
+        } else {
+            fillBlocksScalar(out, blocks, low, range);
+        }
+#else
+        (void)useSimd;
+        fillBlocksScalar(out, blocks, low, range);
+#endif
+        // Końcówka krótsza niż 8 - po jednej liczbie z kolejnych generatorów
+        for (std::size_t i = blocks * laneCount; i < count; ++i) {
+            out[i] = toUniform(nextLane(i - blocks * laneCount), low, range);
+        }
     }
-    outputFile << jsonData.dump(4);
-    outputFile.close();
-}
+};
 
-// Wczytuje stan gry z pliku JSON
-void loadScoreFromJson(const std::string& filename, std::vector<GameData>& gameDataList, sf::Vector2f& ufoPosition, int& score) {
-    std::ifstream inputFile(filename);
-    if (!inputFile.is_open()) {
-        std::cerr << "Nie udało się otworzyć pliku do wczytania stanu gry!" << std::endl;
-        return;
+// System zadań z podkradaniem pracy: każdy wątek roboczy ma własną kolejkę (deque),
+// właściciel bierze zadania z końca, bezczynne wątki podkradają z początku cudzych kolejek.
+// Zadanie to zakres indeksów i wskaźnik na funkcję - zlecenie parallelFor nie alokuje pamięci
+class JobSystem {
+private:
+    struct Job {
+        void (*invoke)(void *context, std::size_t begin, std::size_t end) = nullptr;
+        void *context = nullptr;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        std::atomic<std::size_t> *remaining = nullptr;  // Licznik niedokończonych zadań zlecenia
+    };
+
+    // Kolejka jednego wątku: pierścień o stałej pojemności pod własną, krótko trzymaną blokadą
+    struct WorkerQueue {
+        static constexpr std::size_t Capacity = 256;
+        std::array<Job, Capacity> jobs;
+        std::size_t head = 0;  // Początek - tu podkradają inni
+        std::size_t tail = 0;  // Koniec - tu dokłada i stąd bierze właściciel
+        std::mutex mutex;
+
+        bool push(const Job &job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tail - head == Capacity) {
+                return false;
+            }
+            jobs[tail++ % Capacity] = job;
+            return true;
+        }
+
+        bool popBack(Job &job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tail == head) {
+                return false;
+            }
+            job = jobs[--tail % Capacity];
+            return true;
+        }
+
+        bool stealFront(Job &job) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tail == head) {
+                return false;
+            }
+            job = jobs[head++ % Capacity];
+            return true;
+        }
+    };
+
+    // Kolejka 0 należy do wątku zlecającego, 1..n do wątków roboczych
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<std::size_t> queuedJobs{0};
+    std::mutex wakeMutex;                 // Tylko do usypiania bezczynnych wątków
+    std::condition_variable wakeCondition;
+
+    bool takeJob(std::size_t self, Job &job) {
+        if (queues[self]->popBack(job)) {
+            return true;
+        }
+        for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+            if (queues[(self + offset) % queues.size()]->stealFront(job)) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    // Wczytanie JSON
-    nlohmann::json jsonData;
-    try {
-        inputFile >> jsonData;
-    } catch (const std::exception& e) {
-        std::cerr << "Błąd podczas wczytywania danych JSON: " << e.what() << std::endl;
-        return;
+    void execute(const Job &job) {
+        queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        job.invoke(job.context, job.begin, job.end);
+        job.remaining->fetch_sub(1, std::memory_order_release);
     }
-    inputFile.close();
 
-    gameDataList.clear();
+    void workerLoop(std::size_t self) {
+        Job job;
+        while (!stopRequested.load(std::memory_order_relaxed)) {
+            if (takeJob(self, job)) {
+                execute(job);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCondition.wait(lock, [this] {
+                return queuedJobs.load(std::memory_order_relaxed) > 0 || stopRequested.load(std::memory_order_relaxed);
+            });
+        }
+    }
 
-    // Konwersja danych JSON na obiekty GameData
-    if (jsonData.contains("games")) {
-        for (const auto& entry : jsonData["games"]) {
-            GameData gameData;
-            gameData.position = sf::Vector2f(entry["position"][0], entry["position"][1]);
-            gameData.score = entry["score"];
-            gameData.date = entry["date"];
-            gameDataList.push_back(gameData);
+public:
+    // workerCount - liczba dodatkowych wątków (wątek zlecający też wykonuje zadania)
+    explicit JobSystem(std::size_t workerCount) {
+        for (std::size_t i = 0; i <= workerCount; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (std::size_t i = 1; i <= workerCount; ++i) {
+            workers.emplace_back(&JobSystem::workerLoop, this, i);
         }
+    }
 
-        // Aktualizacja stanu gry 
-        if (!gameDataList.empty()) {
-            const auto& lastGameData = gameDataList.back();
-            ufoPosition = lastGameData.position;
-            score = lastGameData.score;
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            stopRequested.store(true);
+        }
+        wakeCondition.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
         }
     }
-}
 
-class Interfejs {
-private:
-    sf::Text gameOverText;          // Tekst "Game Over"
-    bool isGameOver = false;        // Flaga końca gry
-    sf::RectangleShape rectangle;   // Prostokąt obszaru gry
-    sf::Texture backgroundTexture;  // Tekstura tła
-    sf::Sprite backgroundSprite;    // Sprite tła
-    sf::Font font;                  // Czcionka
-    sf::Text rightTopText;          // Tekst w prawym górnym rogu
-    sf::Text bottomText;            // Tekst na dole ekranu
-    sf::Text scoreText;             // Tekst wyniku
-    sf::Text helpText;              // Tekst pomocy
-    sf::Text pauseText;             // Tekst pauzy
-    bool showHelp = false;          // Flaga wyświetlania pomocy
-    bool showPause = false;         // Flaga pauzy
-    bool exitRequested = false;     // Flaga żądania wyjścia
-    sf::Vector2f size;              // Rozmiar okna
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
 
-    // Inicjalizacja komponentów interfejsu
-    void init() {
-        // Ładowanie czcionki
-        if (!font.loadFromFile("arial.ttf")) {
-            throw std::runtime_error("Bląd");
+    std::size_t getThreadCount() const {
+        return queues.size();
+    }
+
+    // Wywołanie body(begin, end) dla kolejnych zakresów [0, count) po grain indeksów
+    // Powrót dopiero po wykonaniu wszystkich zakresów; body nie może zlecać kolejnych parallelFor
+    template <typename Body>
+    void parallelFor(std::size_t count, std::size_t grain, Body &body) {
+        const std::size_t chunks = (count + grain - 1) / grain;
+        if (chunks <= 1 || queues.size() == 1) {
+            if (count > 0) {
+                body(std::size_t(0), count);
+            }
+            return;
         }
 
-        // Konfiguracja tekstu w prawym górnym rogu
-        rightTopText.setFont(font);
-        rightTopText.setCharacterSize(20);
-        rightTopText.setFillColor(sf::Color::Yellow);
-        rightTopText.setPosition(size.x - 200, 5);
+        std::atomic<std::size_t> remaining{chunks};
+        Job job;
+        job.invoke = [](void *context, std::size_t begin, std::size_t end) {
+            (*static_cast<Body *>(context))(begin, end);
+        };
+        job.context = &body;
+        job.remaining = &remaining;
 
-        // Konfiguracja tekstu na dole
-        bottomText.setFont(font);
-        bottomText.setString("---------------Pomoc F1-------------------------------------------------------------------------------------------------------------------------------------------Menu M---------------");
-        bottomText.setCharacterSize(20);
-        bottomText.setFillColor(sf::Color::Yellow);
-        bottomText.setPosition(10, size.y - bottomText.getLocalBounds().height - 20);
+        // Zakresy rozdzielane po kolei między kolejki; gdy kolejka jest pełna, zakres wykonuje zlecający
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+            job.begin = chunk * grain;
+            job.end = std::min(count, job.begin + grain);
+            queuedJobs.fetch_add(1, std::memory_order_relaxed);
+            if (!queues[chunk % queues.size()]->push(job)) {
+                execute(job);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wakeCondition.notify_all();
 
-        // Konfiguracja tekstu wyniku
-        scoreText.setFont(font);
-        scoreText.setCharacterSize(20);
-        scoreText.setFillColor(sf::Color::Yellow);
-        scoreText.setPosition(10, 5);
+        // Wątek zlecający pracuje razem z innymi, aż wszystkie zakresy będą gotowe
+        Job own;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (takeJob(0, own)) {
+                execute(own);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
 
-        // Konfiguracja prostokąta obszaru gry
-        rectangle.setSize(sf::Vector2f(size.x, size.y - 100));
-        rectangle.setPosition((size.x - rectangle.getSize().x), (size.y - rectangle.getSize().y) / 2);
-        rectangle.setFillColor(sf::Color::Transparent);
-        rectangle.setOutlineThickness(1.f);
-        rectangle.setOutlineColor(sf::Color::White);
+// Wspólny system zadań gry: tyle wątków, ile rdzeni (razem z wątkiem gry)
+JobSystem &getJobSystem() {
+    static JobSystem jobs(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return jobs;
+}
 
-        // Ładowanie i konfiguracja tła
-        if (!backgroundTexture.loadFromFile("space.jpg")) {
-            throw std::runtime_error("Błąd");
-        }
+// Liczba obiektów w jednym zadaniu aktualizacji; wielokrotność 64, żeby zadania zapisywały rozłączne słowa masek
+constexpr std::size_t entityJobGrain = 8192;
 
-        backgroundSprite.setTexture(backgroundTexture);
-        sf::Vector2f scale(
-            rectangle.getSize().x / backgroundTexture.getSize().x,
-            rectangle.getSize().y / backgroundTexture.getSize().y
-        );
-        backgroundSprite.setScale(scale);
-        backgroundSprite.setPosition(rectangle.getPosition());
+// Magazyn ruchomych obiektów (przeszkody, nagrody) w układzie struktur tablic (SoA)
+// Każda cecha leży w osobnej, ciągłej tablicy, więc aktualizacja i kolizje czytają tylko potrzebne dane
+// Działa jak pula o stałej pojemności: pamięć jest rezerwowana raz w setCapacity, add i remove są O(1)
+// i nigdy nie alokują, a zajęte miejsca są zawsze na początku tablic (bez dziur do pomijania)
+struct EntityStore {
+    std::vector<float> x;                // Pozycja - lewy górny róg
+    std::vector<float> y;
+    std::vector<float> previousX;        // Pozycja z poprzedniego kroku (do interpolacji przy rysowaniu)
+    std::vector<float> previousY;
+    std::vector<float> velocityX;        // Prędkość pozioma w pikselach na sekundę (ujemna = w lewo)
+    std::vector<float> width;            // Rozmiar prostokąta ograniczającego
+    std::vector<float> height;
+    std::vector<EntityKind> kind;        // Rodzaj obiektu
+    std::vector<std::uint64_t> wrappedMask;  // Bufor roboczy kernela: obiekty do ponownego wypuszczenia
+    std::size_t poolCapacity = 0;
 
-        // Konfiguracja tekstu pomocy
-        helpText.setFont(font);
-        helpText.setString("Menu kliknij M\n\nAby wznowic rozgrywke prosze nacisnac F1\n\nAby zakonczyc gre prosze nacisnac ECS");
-        helpText.setCharacterSize(30);
-        helpText.setFillColor(sf::Color::White);
+    std::size_t size() const {
+        return x.size();
+    }
 
-        // Konfiguracja tekstu pauzy
-        pauseText.setFont(font);
-        pauseText.setString("\n\n\n\n\n\n\n\n\nWcisnij ESC aby napewno zakonczyc rozgrywke\n\n Aby kontynuowac rozgrywke wcisnij Shift");
-        pauseText.setCharacterSize(30);
-        pauseText.setFillColor(sf::Color::Red);
-        
-        centerText(helpText);
-        centerText(pauseText);
+    std::size_t capacity() const {
+        return poolCapacity;
     }
 
-    // centrowanie tekstu na ekranie
-    void centerText(sf::Text &text) {
-        sf::FloatRect textBounds = text.getLocalBounds();
-        text.setPosition((size.x - textBounds.width) / 2, (size.y - textBounds.height) / 2);
+    void clear() {
+        x.clear();
+        y.clear();
+        previousX.clear();
+        previousY.clear();
+        velocityX.clear();
+        width.clear();
+        height.clear();
+        kind.clear();
     }
 
-public:
-    // Konstruktor
-    Interfejs(const sf::Vector2f &windowSize) : size(windowSize) {
-        init();
+    // Pojemność puli; mniejsza niż dotychczasowa nie zwalnia pamięci, więc zmiana poziomu nie alokuje
+    void setCapacity(std::size_t count) {
+        poolCapacity = count;
+        wrappedMask.reserve(entityMaskWords(count));
+        x.reserve(count);
+        y.reserve(count);
+        previousX.reserve(count);
+        previousY.reserve(count);
+        velocityX.reserve(count);
+        width.reserve(count);
+        height.reserve(count);
+        kind.reserve(count);
     }
 
-    // Ustawienie tekstów w interfejsie
-    void setText(const std::string &right, int score) {
-        rightTopText.setString(right);
-        scoreText.setString("Punkty: " + std::to_string(score));
+    // Dodanie obiektu poruszającego się w lewo z prędkością speed
+    // Zwraca false, gdy pula jest pełna (tablice nigdy nie rosną ponad pojemność)
+    bool add(EntityKind entityKind, float posX, float posY, float speed, const sf::Vector2f &size) {
+        if (x.size() >= poolCapacity) {
+            return false;
+        }
+        x.push_back(posX);
+        y.push_back(posY);
+        previousX.push_back(posX);
+        previousY.push_back(posY);
+        velocityX.push_back(-speed);
+        width.push_back(size.x);
+        height.push_back(size.y);
+        kind.push_back(entityKind);
+        return true;
     }
 
-    // Aktualizacja tekstów w interfejsie
-    void updateTexts(const sf::Vector2f &position, int score) {
-        std::ostringstream ss;
-        ss << "Pozycja: (" << static_cast<int>(position.x) << ", " << static_cast<int>(position.y) << ")";
-        rightTopText.setString(ss.str());
-        scoreText.setString("Punkty: " + std::to_string(score));
+    // Zwolnienie miejsca w puli przez zamianę z ostatnim (zmienia kolejność, ale nie przesuwa tablic)
+    void remove(std::size_t index) {
+        const std::size_t last = size() - 1;
+        x[index] = x[last];
+        y[index] = y[last];
+        previousX[index] = previousX[last];
+        previousY[index] = previousY[last];
+        velocityX[index] = velocityX[last];
+        width[index] = width[last];
+        height[index] = height[last];
+        kind[index] = kind[last];
+        x.pop_back();
+        y.pop_back();
+        previousX.pop_back();
+        previousY.pop_back();
+        velocityX.pop_back();
+        width.pop_back();
+        height.pop_back();
+        kind.pop_back();
     }
 
-    // Pokazanie tekstu końca gry
-    void showGameOver() {
-        gameOverText.setString("Game Over");
-        centerText(gameOverText);
+    sf::FloatRect getBounds(std::size_t index) const {
+        return sf::FloatRect(x[index], y[index], width[index], height[index]);
     }
 
-    // Metody zarządzające stanem interfejsu
-    void toggleHelp() { showHelp = !showHelp; }
-    void togglePause() { showPause = !showPause; }
-    void resumeGame() { showPause = false; }
-    void requestExit() { exitRequested = true; }
-    bool isHelpVisible() const { return showHelp; }
-    bool isPauseVisible() const { return showPause; }
-    bool isExitRequested() const { return exitRequested; }
-    sf::FloatRect getCentralBounds() const { return rectangle.getGlobalBounds(); }
-
-    // Rysowanie interfejsu
-    void draw(sf::RenderWindow &window) {
-        window.draw(backgroundSprite);
-        window.draw(rectangle);
-        window.draw(bottomText);
-        window.draw(rightTopText);
-        window.draw(scoreText);
-        
-        if (isGameOver) {
-            window.draw(gameOverText);
-        }
-        if (showHelp) {
-            window.draw(helpText);
-        }
-        if (showPause) {
-            window.draw(pauseText);
-        }
+    // Aktualizacja pozycji wszystkich obiektów w każdej klatce gry i test przecięcia z UFO (kernel SIMD)
+    // Obiekt, który wyszedł poza lewą krawędź, wraca z prawej na losowej wysokości
+    // hitMask: bit i ustawiony, gdy obiekt i przecina ufoBounds
+    // Duże zbiory są dzielone na zakresy wykonywane równolegle przez jobs; każdy zakres zapisuje tylko
+    // swoje pozycje i swoje słowa masek, a reakcje na wynik są liczone po kolei w Simulation::step,
+    // więc wynik nie zależy od liczby wątków ani kolejności wykonania zadań
+    // respawnSeed: ziarno tego kroku; wysokości odradzanych obiektów losuje strumień Random
+    // przypisany do bloku entityJobGrain indeksów - tak samo przy jednym i wielu wątkach
+    void update(float deltaTime, const sf::FloatRect &bounds, const sf::FloatRect &ufoBounds, std::vector<std::uint64_t> &hitMask,
+                std::uint64_t respawnSeed, JobSystem &jobs = getJobSystem()) {
+        const std::size_t words = entityMaskWords(size());
+        wrappedMask.resize(words);
+        hitMask.resize(words);
+
+        auto updateRange = [&](std::size_t begin, std::size_t end) {
+            std::copy(x.begin() + begin, x.begin() + end, previousX.begin() + begin);
+            std::copy(y.begin() + begin, y.begin() + end, previousY.begin() + begin);
+            EntityKernelInput input = {x.data() + begin, y.data() + begin, velocityX.data() + begin,
+                                       width.data() + begin, height.data() + begin, end - begin};
+            activeEntityKernel(input, deltaTime, bounds.left, ufoBounds, wrappedMask.data() + begin / 64, hitMask.data() + begin / 64);
+
+            // Obiekty za lewą krawędzią są rzadkie - przechodzimy tylko po ustawionych bitach tego zakresu
+            std::size_t streamBlock = std::numeric_limits<std::size_t>::max();
+            Random random;
+            for (std::size_t word = begin / 64; word < entityMaskWords(end); ++word) {
+                for (std::uint64_t bits = wrappedMask[word]; bits != 0; bits &= bits - 1) {
+                    const std::size_t i = word * 64 + static_cast<std::size_t>(__builtin_ctzll(bits));
+                    if (i / entityJobGrain != streamBlock) {
+                        streamBlock = i / entityJobGrain;
+                        random = Random::stream(respawnSeed, streamBlock);
+                    }
+                    const float freeHeight = std::max(bounds.height - height[i], 1.f);
+                    x[i] = bounds.left + bounds.width;
+                    y[i] = bounds.top + static_cast<float>(random.below(static_cast<std::uint32_t>(freeHeight)));
+                    // Przeskok na drugą stronę ekranu nie jest interpolowany
+                    previousX[i] = x[i];
+                    previousY[i] = y[i];
+                }
+            }
+        };
+        jobs.parallelFor(size(), entityJobGrain, updateRange);
     }
 };
 
+// Logika rozgrywki: UFO, przeszkody, nagrody, kolizje i punkty
+// Nie korzysta z okna, tekstur ani klawiatury - działa tak samo w grze i w trybie bez okna (--headless)
+class Simulation {
+public:
+    sf::FloatRect bounds;           // Obszar gry
+    Ufo ufo;
+    EntityStore entities;           // Przeszkody i nagrody
+    int score = 0;
+    bool isGameOver = false;
+    float collisionCooldown = 0.f;  // Czas do kolejnej kary za zderzenie (w czasie symulacji)
+    std::uint64_t seed;             // Ziarno sesji - zapisywane razem z wynikiem
+    bool profiled = false;          // Pomiar faz kroku w profilerze klatki (tylko w oknie gry)
 
-// Klasa UFO
-class Ufo {
 private:
-    sf::Vector2f position;
-    float speed = 200.f;
-    sf::Texture texture;
-    sf::Sprite sprite;
+    Random random;                  // Jedyne źródło losowości symulacji
+    sf::Vector2f obstacleSize;
+    sf::Vector2f rewardSize;
+    std::vector<std::uint64_t> ufoHitMask;     // Obiekty stykające się z UFO (wynik kernela)
+    std::vector<std::size_t> collectedRewards; // Bufor zebranych nagród w bieżącym kroku
+    std::vector<float> spawnX, spawnY;         // Bufory losowania pozycji przy zmianie poziomu
+    CollisionWorld placementWorld;             // Siatka przeszkód do szukania wolnego miejsca dla nagród
+    std::vector<std::uint32_t> placementContacts;
+    static constexpr int rewardPlacementAttempts = 8;
 
-public:
-    // Konstruktor
-    Ufo(float x_in, float y_in) {
-        position.x = x_in;
-        position.y = y_in;
-        if (!texture.loadFromFile("ufo.png")) {
-            throw std::runtime_error("Nie można załadować pliku tekstury UFO");
-        }
-        sprite.setTexture(texture);
-        sprite.setPosition(position);
+    // Zebrane nagrody wracają do gry po rewardRespawnDelay; czasy powrotu w buforze cyklicznym
+    // o pojemności równej liczbie nagród (opóźnienie jest stałe, więc kolejność FIFO = kolejność czasów)
+    static constexpr double rewardRespawnDelay = 1.0;
+    std::vector<double> rewardRespawnTimes;
+    std::size_t rewardRespawnHead = 0;
+    std::size_t rewardRespawnCount = 0;
+    float rewardSpeed = 0.f;
+    double time = 0.0;                         // Czas symulacji w sekundach
+
+    // Losowa wysokość nagrody mieszczącej się w całości w obszarze gry
+    float randomRewardY() {
+        const float freeHeight = std::max(bounds.height - rewardSize.y, 1.f);
+        return bounds.top + static_cast<float>(random.below(static_cast<std::uint32_t>(freeHeight)));
     }
 
-    // Metoda aktualizująca pozycję UFO
-    void update(float deltaTime, const sf::FloatRect &bounds) {
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
-            position.x -= speed * deltaTime;
-        }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
-            position.x += speed * deltaTime;
-        }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up)) {
-            position.y -= speed * deltaTime;
+    // Wysokość, na której nagroda w kolumnie x nie nachodzi na żadną przeszkodę z placementWorld;
+    // y - pierwsza propozycja. Po kilku nieudanych losowaniach (gęsto ustawione przeszkody) zostaje ostatnia
+    float findRewardPlace(float x, float y) {
+        for (int attempt = 1; attempt < rewardPlacementAttempts; ++attempt) {
+            placementWorld.query(sf::FloatRect(x, y, rewardSize.x, rewardSize.y), placementContacts);
+            if (placementContacts.empty()) {
+                break;
+            }
+            y = randomRewardY();
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down)) {
-            position.y += speed * deltaTime;
+        return y;
+    }
+
+    // Nagroda z puli wraca za prawą krawędzią na losowej wysokości
+    // (poza widokiem, więc bez szukania wolnego miejsca - budowanie siatki w każdym kroku kosztowałoby O(n))
+    void respawnDueRewards() {
+        while (rewardRespawnCount > 0 && rewardRespawnTimes[rewardRespawnHead] <= time) {
+            entities.add(EntityKind::Reward, bounds.left + bounds.width, randomRewardY(), rewardSpeed, rewardSize);
+            rewardRespawnHead = (rewardRespawnHead + 1) % rewardRespawnTimes.size();
+            --rewardRespawnCount;
         }
+    }
 
-        // Utrzymanie w granicach ekranu
-        if (position.x < bounds.left) {
-            position.x = bounds.left;
+public:
+    Simulation(const sf::FloatRect &playArea, const sf::Vector2f &ufoSize, const sf::Vector2f &obstacleSz, const sf::Vector2f &rewardSz,
+               std::uint64_t sessionSeed)
+        : bounds(playArea),
+          ufo(playArea.left + playArea.width / 2 - 25.f, playArea.top + playArea.height / 2 - 25.f, ufoSize),
+          seed(sessionSeed),
+          random(sessionSeed),
+          obstacleSize(obstacleSz),
+          rewardSize(rewardSz),
+          placementWorld(2.f * std::max({obstacleSz.x, obstacleSz.y, rewardSz.x, rewardSz.y, 1.f})) {}
+
+    // Rozmieszczenie przeszkód i nagród w losowych miejscach obszaru gry
+    // Współrzędne losowane hurtem (8 generatorów naraz), potem dopisywane do tablic obiektów
+    // Bufory robocze mają pojemność puli, więc kroki symulacji nie alokują pamięci
+    void initializeEntities(int numObstacles, int numRewards, float obstacleSpeed) {
+        const std::size_t total = static_cast<std::size_t>(numObstacles + numRewards);
+        spawnX.resize(total);
+        spawnY.resize(total);
+        RandomLanes lanes(random.next64());
+        lanes.fillUniform(spawnX.data(), total, bounds.left, bounds.left + bounds.width);
+        lanes.fillUniform(spawnY.data(), total, bounds.top, bounds.top + bounds.height);
+
+        entities.clear();
+        entities.setCapacity(total);
+        ufoHitMask.reserve(entityMaskWords(total));
+        collectedRewards.reserve(static_cast<std::size_t>(numRewards));
+        placementWorld.reserve(static_cast<std::size_t>(numObstacles));
+        placementContacts.reserve(static_cast<std::size_t>(numObstacles));
+        rewardRespawnTimes.resize(std::max(numRewards, 1));
+        rewardRespawnHead = 0;
+        rewardRespawnCount = 0;
+        rewardSpeed = obstacleSpeed / 2;
+        const std::size_t obstacleCount = static_cast<std::size_t>(numObstacles);
+        for (std::size_t i = 0; i < obstacleCount; ++i) {
+            entities.add(EntityKind::Obstacle, spawnX[i], spawnY[i], obstacleSpeed, obstacleSize);
         }
-        if (position.x + sprite.getGlobalBounds().width > bounds.left + bounds.width) {
-            position.x = bounds.left + bounds.width - sprite.getGlobalBounds().width;
+
+        // Nagrody są rozmieszczane tak, żeby nie leżały na przeszkodach; każda próba to zapytanie do siatki,
+        // a nie przegląd wszystkich przeszkód
+        placementWorld.clear();
+        for (std::size_t i = 0; i < obstacleCount; ++i) {
+            placementWorld.add(EntityKind::Obstacle, entities.getBounds(i));
         }
-        if (position.y < bounds.top) {
-            position.y = bounds.top;
+        placementWorld.build();
+        for (std::size_t i = obstacleCount; i < total; ++i) {
+            entities.add(EntityKind::Reward, spawnX[i], findRewardPlace(spawnX[i], spawnY[i]), rewardSpeed, rewardSize);
         }
-        if (position.y + sprite.getGlobalBounds().height > bounds.top + bounds.height) {
-            position.y = bounds.top + bounds.height - sprite.getGlobalBounds().height;
+    }
+
+    // Jeden krok symulacji: ruch, kolizje, punkty
+    // Zwraca true, gdy w tym kroku gra się zakończyła
+    bool step(float deltaTime, const InputState &input) {
+        // Aktualizacja pozycji UFO
+        {
+            ProfileScope scope(ProfilePhase::UfoUpdate, profiled);
+            ufo.update(deltaTime, bounds, input);
         }
 
-        sprite.setPosition(position);
-    }
+        // Ruch przeszkód i nagród połączony z testem przecięcia z UFO
+        // (ten przebieg i tak dotyka każdego obiektu, więc test z UFO nie korzysta z siatki CollisionWorld)
+        ProfileScope scope(ProfilePhase::EntityUpdate, profiled);
+        entities.update(deltaTime, bounds, ufo.getBounds(), ufoHitMask, random.next64());
+        collisionCooldown -= deltaTime;
+        time += deltaTime;
+
+        bool gameOverNow = false;
+        collectedRewards.clear();
+        forEachSetBit(ufoHitMask, [&](std::size_t contact) {
+            // Kolizja z przeszkodą (kara najwyżej raz na pół sekundy)
+            if (entities.kind[contact] == EntityKind::Obstacle) {
+                if (collisionCooldown <= 0.f) {
+                    score -= 1;
+                    collisionCooldown = 0.5f;
+                    if (score < 0 && !isGameOver) {
+                        isGameOver = true;
+                        gameOverNow = true;
+                    }
+                }
+            } else if (entities.kind[contact] == EntityKind::Reward) {
+                // Zebranie nagrody
+                score += 1;
+                collectedRewards.push_back(contact);
+            }
+        });
 
-    // Metoda rysująca UFO
-    void draw(sf::RenderWindow &window) {
-        window.draw(sprite);
+        // Usuwanie zebranych nagród od końca, żeby zamiana z ostatnim nie ruszyła nieusuniętych indeksów;
+        // zwolnione miejsca w puli czekają na powrót nagrody
+        for (auto it = collectedRewards.rbegin(); it != collectedRewards.rend(); ++it) {
+            entities.remove(*it);
+            const std::size_t tail = (rewardRespawnHead + rewardRespawnCount) % rewardRespawnTimes.size();
+            rewardRespawnTimes[tail] = time + rewardRespawnDelay;
+            ++rewardRespawnCount;
+        }
+        respawnDueRewards();
+        return gameOverNow;
     }
 
-    // Pobranie prostokąta granicznego UFO
-    sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
+    const sf::Vector2f &getObstacleSize() const {
+        return obstacleSize;
     }
 
-    // Pobranie pozycji UFO
-    sf::Vector2f getPosition() const {
-        return position;
+    const sf::Vector2f &getRewardSize() const {
+        return rewardSize;
     }
 
-    // Ustawienie pozycji UFO (dla ładowania z pliku)
-    void setPosition(const sf::Vector2f &newPosition) {
-        position = newPosition;
-        sprite.setPosition(position);
+    // Skrót stanu (FNV-1a) - porównywany po każdym kroku przy odtwarzaniu nagrania
+    std::uint32_t stateHash() const {
+        const sf::Vector2f position = ufo.getPosition();
+        const std::uint32_t count = static_cast<std::uint32_t>(entities.size());
+        const std::uint8_t gameOver = isGameOver ? 1 : 0;
+        std::uint32_t hash = fnv1a(reinterpret_cast<const unsigned char *>(&position), sizeof(position));
+        hash = fnv1a(reinterpret_cast<const unsigned char *>(&score), sizeof(score), hash);
+        hash = fnv1a(&gameOver, sizeof(gameOver), hash);
+        hash = fnv1a(reinterpret_cast<const unsigned char *>(&collisionCooldown), sizeof(collisionCooldown), hash);
+        hash = fnv1a(reinterpret_cast<const unsigned char *>(&count), sizeof(count), hash);
+        hash = fnv1a(reinterpret_cast<const unsigned char *>(entities.x.data()), count * sizeof(float), hash);
+        return fnv1a(reinterpret_cast<const unsigned char *>(entities.y.data()), count * sizeof(float), hash);
     }
 };
 
-// Klasa reprezentująca przeszkody w grze
-class Obstacle {
+// Nagrywanie wejścia do odtworzenia sesji: ./prog --record plik, potem ./prog --replay plik [--render]
+// Plik: nagłówek z ziarnem i wymiarami obszaru gry, potem ciąg rekordów. Pierwszy bajt rekordu to typ
+// (starsza połówka); w rekordzie kroku młodsza połówka to strzałki (bity InputKey), a za nim 4 bajty
+// skrótu stanu po kroku. Polecenia zmieniające stan poza krokiem (nowy poziom, wczytanie zapisu,
+// nowa gra) mają własne rekordy; pauza i ekrany nie są zapisywane - w tym czasie nie ma kroków
+struct ReplayFileHeader {
+    char magic[4];              // "SGRP"
+    std::uint32_t version;
+    std::uint64_t seed;         // Ziarno sesji (Simulation::seed)
+    float simulationStep;
+    float boundsLeft;
+    float boundsTop;
+    float boundsWidth;
+    float boundsHeight;
+    float ufoWidth;
+    float ufoHeight;
+    float obstacleWidth;
+    float obstacleHeight;
+    float rewardWidth;
+    float rewardHeight;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(ReplayFileHeader) == 64, "Zmiana układu nagłówka nagrania wymaga nowej wersji formatu");
+
+const std::uint32_t replayFileVersion = 3;  // 2 - nagrody wracają z puli, 3 - nagrody startują obok przeszkód
+
+enum ReplayRecordType : std::uint8_t {
+    ReplayTick = 0x00,          // + uint32 skrót stanu
+    ReplaySpawn = 0x10,         // + int32 przeszkody, int32 nagrody, float prędkość
+    ReplayRestore = 0x20,       // + float x, float y, int32 wynik
+    ReplayResume = 0x30         // Nowa gra po końcu gry
+};
+
+// Zapis nagrania w trakcie gry; bez otwartego pliku wszystkie metody nic nie robią
+// Skrót stanu jest liczony tylko podczas nagrywania
+class InputRecorder {
 private:
-    sf::Sprite sprite;          // Obiekt sprite używany do wyświetlania przeszkody na ekranie
-    static sf::Texture texture; // Współdzielona tekstura używana przez wszystkie przeszkody dla optymalizacji pamięci
-    float speed;                // Prędkość poruszania się przeszkody (w pikselach na sekundę)
+    std::FILE *file = nullptr;
+    std::uint64_t ticks = 0;
 
-public:
-    // Konstruktor inicjalizujący przeszkodę
-    Obstacle(float x, float y, float obstacleSpeed = 150.f) : speed(obstacleSpeed) {
-        // Ładowanie tekstury tylko przy pierwszym utworzeniu obiektu
-        if (texture.getSize().x == 0 && texture.getSize().y == 0) {
-            if (!texture.loadFromFile("planeta.png")) {
-                std::cerr << "Błąd" << std::endl;
-            }
+    template <typename... Fields>
+    void writeRecord(std::uint8_t type, const Fields &...fields) {
+        if (!file) {
+            return;
+        }
+        unsigned char buffer[1 + (sizeof(Fields) + ... + 0)];
+        buffer[0] = type;
+        std::size_t offset = 1;
+        ((std::memcpy(buffer + offset, &fields, sizeof(fields)), offset += sizeof(fields)), ...);
+        if (std::fwrite(buffer, sizeof(buffer), 1, file) != 1) {
+            std::cerr << "Błąd zapisu nagrania - nagrywanie przerwane" << std::endl;
+            close();
         }
-        
-        sprite.setTexture(texture);  // Przypisanie tekstury do sprite'a
-        sprite.setPosition(x, y);    // Ustawienie początkowej pozycji przeszkody
     }
 
-    // Aktualizacja pozycji przeszkody w każdej klatce gry
-    void update(float deltaTime, const sf::FloatRect &bounds) {
-        sf::Vector2f position = sprite.getPosition();
-        position.x -= speed * deltaTime;  // Przesunięcie przeszkody w lewo
+public:
+    InputRecorder() = default;
+
+    ~InputRecorder() {
+        close();
+    }
+
+    InputRecorder(const InputRecorder &) = delete;
+    InputRecorder &operator=(const InputRecorder &) = delete;
 
-        // Reset pozycji przeszkody gdy wyjdzie poza lewą krawędź ekranu
-        if (position.x + sprite.getGlobalBounds().width < bounds.left) {
-            position.x = bounds.left + bounds.width;
-            position.y = bounds.top + static_cast<float>(rand() % static_cast<int>(bounds.height - sprite.getGlobalBounds().height));
+    void open(const std::string &filename, const Simulation &simulation, float simulationStep) {
+        close();
+        file = std::fopen(filename.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Nie można utworzyć pliku nagrania " + filename);
         }
+        ReplayFileHeader header = {};
+        std::memcpy(header.magic, "SGRP", 4);
+        header.version = replayFileVersion;
+        header.seed = simulation.seed;
+        header.simulationStep = simulationStep;
+        header.boundsLeft = simulation.bounds.left;
+        header.boundsTop = simulation.bounds.top;
+        header.boundsWidth = simulation.bounds.width;
+        header.boundsHeight = simulation.bounds.height;
+        header.ufoWidth = simulation.ufo.getBounds().width;
+        header.ufoHeight = simulation.ufo.getBounds().height;
+        header.obstacleWidth = simulation.getObstacleSize().x;
+        header.obstacleHeight = simulation.getObstacleSize().y;
+        header.rewardWidth = simulation.getRewardSize().x;
+        header.rewardHeight = simulation.getRewardSize().y;
+        if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+            close();
+            throw std::runtime_error("Błąd zapisu nagłówka nagrania " + filename);
+        }
+        ticks = 0;
+        std::cout << "Nagrywanie wejścia do pliku " << filename << std::endl;
+    }
 
-        sprite.setPosition(position);
+    void close() {
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
     }
 
-    // Rysowanie przeszkody w oknie gry
-    void draw(sf::RenderWindow &window) const {
-        window.draw(sprite);
+    bool isRecording() const {
+        return file != nullptr;
     }
 
-    // Zwraca prostokąt ograniczający przeszkodę
-    sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
+    void recordSpawn(int numObstacles, int numRewards, float obstacleSpeed) {
+        writeRecord(ReplaySpawn, static_cast<std::int32_t>(numObstacles), static_cast<std::int32_t>(numRewards), obstacleSpeed);
+    }
+
+    void recordRestore(const sf::Vector2f &position, int score) {
+        writeRecord(ReplayRestore, position.x, position.y, static_cast<std::int32_t>(score));
+    }
+
+    void recordResume() {
+        writeRecord(ReplayResume);
+    }
+
+    // Wywoływane po każdym kroku symulacji z wejściem, które ten krok dostał
+    void recordTick(const InputState &input, const Simulation &simulation) {
+        if (!file) {
+            return;
+        }
+        writeRecord(static_cast<std::uint8_t>(ReplayTick | (input.keys & 0x0F)), simulation.stateHash());
+        // Bufor stdio opróżniany raz na sekundę symulacji - po awarii gry nagranie jest prawie pełne
+        if (++ticks % 120 == 0) {
+            std::fflush(file);
+        }
     }
 };
 
-// Klasa reprezentująca nagrody w grze
-class Reward {
+// Odtwarzanie nagrania: symulacja odtworzona z nagłówka, potem polecenia i kroki z pliku
+// Po każdym kroku skrót stanu jest porównywany z zapisanym
+class ReplayPlayer {
 private:
-    sf::Sprite sprite;          // Obiekt sprite używany do wyświetlania nagrody
-    static sf::Texture texture; // Współdzielona tekstura używana przez wszystkie nagrody
-    float speed;                // Prędkość poruszania się nagrody (w pikselach na sekundę)
+    MappedFile file;
+    ReplayFileHeader header;
+    std::size_t offset = sizeof(ReplayFileHeader);
+
+    static ReplayFileHeader readHeader(const MappedFile &file, const std::string &filename) {
+        ReplayFileHeader header;
+        if (file.size() < sizeof(header)) {
+            throw std::runtime_error("Brak lub niepełny plik nagrania " + filename);
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, "SGRP", 4) != 0 || header.version != replayFileVersion || !(header.simulationStep > 0.f)) {
+            throw std::runtime_error("Nieobsługiwany plik nagrania " + filename);
+        }
+        return header;
+    }
+
+    // Odczyt pól rekordu; false, gdy plik kończy się w połowie rekordu (przerwane nagrywanie)
+    template <typename... Fields>
+    bool readFields(Fields &...fields) {
+        if (file.size() - offset < (sizeof(Fields) + ... + 0)) {
+            offset = file.size();
+            return false;
+        }
+        ((std::memcpy(&fields, file.data() + offset, sizeof(fields)), offset += sizeof(fields)), ...);
+        return true;
+    }
 
 public:
-    // Konstruktor inicjalizujący nagrodę
-    Reward(float x, float y, float rewardSpeed = 100.f) : speed(rewardSpeed) {
-        // Ładowanie tekstury tylko przy pierwszym utworzeniu obiektu
-        if (texture.getSize().x == 0 && texture.getSize().y == 0) {
-            if (!texture.loadFromFile("kometa.png")) {
-                std::cerr << "Nie udało się załadować tekstury nagrody!" << std::endl;
+    Simulation simulation;
+    std::uint64_t ticks = 0;            // Wykonane kroki
+    std::uint64_t firstMismatch = 0;    // Numer (od 1) pierwszego kroku z innym skrótem stanu, 0 - brak
+
+    explicit ReplayPlayer(const std::string &filename)
+        : file(filename),
+          header(readHeader(file, filename)),
+          simulation(sf::FloatRect(header.boundsLeft, header.boundsTop, header.boundsWidth, header.boundsHeight),
+                     sf::Vector2f(header.ufoWidth, header.ufoHeight), sf::Vector2f(header.obstacleWidth, header.obstacleHeight),
+                     sf::Vector2f(header.rewardWidth, header.rewardHeight), header.seed) {}
+
+    float getSimulationStep() const {
+        return header.simulationStep;
+    }
+
+    // Polecenia poprzedzające krok i sam krok; false na końcu nagrania
+    bool advance() {
+        while (offset < file.size()) {
+            const std::uint8_t type = file.data()[offset++];
+            switch (type & 0xF0) {
+            case ReplayTick: {
+                std::uint32_t expected = 0;
+                if (!readFields(expected)) {
+                    return false;
+                }
+                InputState input;
+                input.keys = type & 0x0F;
+                simulation.step(header.simulationStep, input);
+                ++ticks;
+                if (firstMismatch == 0 && simulation.stateHash() != expected) {
+                    firstMismatch = ticks;
+                    std::cerr << "Rozbieżność stanu w kroku " << ticks << std::endl;
+                }
+                return true;
+            }
+            case ReplaySpawn: {
+                std::int32_t numObstacles = 0;
+                std::int32_t numRewards = 0;
+                float obstacleSpeed = 0.f;
+                if (!readFields(numObstacles, numRewards, obstacleSpeed)) {
+                    return false;
+                }
+                simulation.initializeEntities(numObstacles, numRewards, obstacleSpeed);
+                break;
+            }
+            case ReplayRestore: {
+                sf::Vector2f position;
+                std::int32_t score = 0;
+                if (!readFields(position.x, position.y, score)) {
+                    return false;
+                }
+                simulation.ufo.setPosition(position);
+                simulation.score = score;
+                break;
+            }
+            case ReplayResume:
+                simulation.isGameOver = false;
+                break;
+            default:
+                throw std::runtime_error("Uszkodzony plik nagrania (nieznany rekord)");
             }
         }
+        return false;
+    }
+};
 
-        sprite.setTexture(texture);  // Przypisanie tekstury do sprite'a
-        sprite.setPosition(x, y);    // Ustawienie początkowej pozycji nagrody
+// Skalowanie równoległej aktualizacji obiektów: ./prog --bench-jobs [liczba_obiektów] [kroki]
+// Dla 1, 2, 4, 8... wątków (do liczby rdzeni); pozycje i trafienia muszą wyjść identyczne jak na jednym wątku
+void runJobSystemBenchmark(std::size_t count, int steps) {
+    const sf::FloatRect bounds(0.f, 50.f, 1200.f, 650.f);
+    const sf::FloatRect ufoBounds(575.f, 350.f, 50.f, 50.f);
+    const float deltaTime = 1.f / 120.f;
+
+    EntityStore initial;
+    initial.setCapacity(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        float x = bounds.left + static_cast<float>((i * 7919) % static_cast<std::size_t>(bounds.width));
+        float y = bounds.top + static_cast<float>((i * 104729) % static_cast<std::size_t>(bounds.height - 40.f));
+        initial.add(i % 4 == 0 ? EntityKind::Reward : EntityKind::Obstacle, x, y, 100.f + static_cast<float>(i % 5) * 25.f, sf::Vector2f(40.f, 40.f));
     }
 
-    // Aktualizacja pozycji nagrody w każdej klatce gry
-    void update(float deltaTime, const sf::FloatRect &bounds) {
-        sf::Vector2f position = sprite.getPosition();
-        position.x -= speed * deltaTime;  // Przesunięcie nagrody w lewo
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<float> referenceX;
+    std::size_t referenceHits = 0;
+    double singleThreadMs = 0.0;
+    for (unsigned threads = 1; threads <= std::max(cores, 8u); threads *= 2) {
+        JobSystem jobs(threads - 1);
+        EntityStore entities = initial;
+        std::vector<std::uint64_t> hits;
+        std::size_t hitCount = 0;
+        Random random(1);
 
-        // Reset pozycji nagrody gdy wyjdzie poza lewą krawędź ekranu
-        if (position.x + sprite.getGlobalBounds().width < bounds.left) {
-            position.x = bounds.left + bounds.width;
-            position.y = bounds.top + static_cast<float>(rand() % static_cast<int>(bounds.height - sprite.getGlobalBounds().height));
+        sf::Clock clock;
+        for (int step = 0; step < steps; ++step) {
+            entities.update(deltaTime, bounds, ufoBounds, hits, random.next64(), jobs);
+            for (std::uint64_t word : hits) {
+                hitCount += static_cast<std::size_t>(__builtin_popcountll(word));
+            }
         }
+        const double stepMs = clock.getElapsedTime().asMicroseconds() / 1000.0 / steps;
 
-        sprite.setPosition(position);
+        if (referenceX.empty()) {
+            referenceX = entities.x;
+            referenceHits = hitCount;
+            singleThreadMs = stepMs;
+        }
+        const bool matches = entities.x == referenceX && hitCount == referenceHits;
+        std::cout << "Wątki: " << jobs.getThreadCount() << (threads > cores ? " (więcej niż rdzeni)" : "") << ", " << stepMs << " ms/krok, x"
+                  << (stepMs > 0 ? singleThreadMs / stepMs : 0.0) << (matches ? "" : " - WYNIKI RÓŻNE!") << std::endl;
     }
+}
 
-    // Rysowanie nagrody w oknie gry
-    void draw(sf::RenderWindow &window) const {
-        window.draw(sprite);
+// Liczba z wiersza poleceń: cały napis musi być liczbą mieszczącą się w typie, bez znaku minus
+// Zwraca false zamiast rzucać wyjątek, żeby wywołujący mógł wypisać sposób użycia
+template <typename T>
+bool parseNumberArgument(const char *text, T &value) {
+    const char *end = text + std::strlen(text);
+    T parsed = 0;
+    const std::from_chars_result result = std::from_chars(text, end, parsed);
+    if (result.ec != std::errc() || result.ptr != end || result.ptr == text) {
+        return false;
+    }
+    if constexpr (std::is_signed<T>::value) {
+        if (parsed < 0) {
+            return false;
+        }
     }
+    value = parsed;
+    return true;
+}
 
-    // Zwraca prostokąt ograniczający nagrodę
-    sf::FloatRect getBounds() const {
-        return sprite.getGlobalBounds();
+// Pomiar przepustowości symulacji bez okna: ./prog --headless [liczby_obiektów] [kroki] [ziarno]
+// liczby_obiektów - lista oddzielona przecinkami, np. 1000,10000,100000
+// Wejście jest skryptowane: UFO zmienia kierunek co sekundę symulacji
+// Zwraca false przy niepoprawnej liczbie obiektów na liście
+bool runHeadlessBenchmark(const std::string &entityCounts, int ticks, std::uint64_t seed) {
+    const sf::FloatRect playArea(0.f, 50.f, 1200.f, 650.f);
+    const float simulationStep = 1.f / 120.f;
+    const std::uint8_t script[] = {InputRight, InputRight | InputDown, InputDown, InputLeft | InputDown,
+                                   InputLeft, InputLeft | InputUp, InputUp, InputRight | InputUp};
+
+    std::stringstream counts(entityCounts);
+    std::string item;
+    while (std::getline(counts, item, ',')) {
+        int entityCount = 0;
+        if (!parseNumberArgument(item.c_str(), entityCount)) {
+            std::cerr << "Niepoprawna liczba obiektów: " << item << std::endl;
+            return false;
+        }
+
+        // Rozmiary jak w grafikach gry; 3/4 obiektów to przeszkody, reszta nagrody
+        Simulation simulation(playArea, sf::Vector2f(50.f, 50.f), sf::Vector2f(40.f, 40.f), sf::Vector2f(32.f, 32.f), seed);
+        simulation.initializeEntities(entityCount - entityCount / 4, entityCount / 4, 150.f);
+        simulation.score = 1 << 30;  // Przy tysiącach przeszkód gra skończyłaby się od razu
+
+        sf::Clock clock;
+        for (int tick = 0; tick < ticks; ++tick) {
+            InputState input;
+            input.keys = script[(tick / 120) % 8];
+            simulation.step(simulationStep, input);
+        }
+        const double seconds = std::max(clock.getElapsedTime().asMicroseconds(), sf::Int64(1)) / 1e6;
+
+        std::cout << "Obiekty: " << entityCount << ", kroki: " << ticks
+                  << ", kroki/s: " << static_cast<long long>(ticks / seconds)
+                  << ", obiekty*kroki/s: " << static_cast<long long>(static_cast<double>(entityCount) * ticks / seconds)
+                  << ", kernel: " << entityKernelName(activeEntityKernel)
+                  << ", wynik: " << simulation.score - (1 << 30) << std::endl;
     }
-};
-// Inicjalizowanie statycznej tekstury na poziomie klasy
-sf::Texture Reward::texture;
+    return true;
+}
 
-// Struktura przechowująca konfigurację poziomu gry
-struct Level {
-    sf::Color backgroundColor;  // Kolor tła dla danego poziomu
-    float obstacleSpeed;        // Prędkość przeszkód na tym poziomie
-    int numObstacles;          // Liczba przeszkód na poziomie
+// Niezmienna kopia położeń UFO, przeszkód i nagród dla wątku renderującego
+// Tablice są nadpisywane przez assign, więc po rozgrzaniu kopiowanie nie alokuje pamięci
+struct WorldSnapshot {
+    sf::Vector2f ufoPosition;
+    sf::Vector2f ufoPreviousPosition;
+    std::vector<float> x, y;
+    std::vector<float> previousX, previousY;
+    std::vector<EntityKind> kind;
+
+    void capture(const Ufo &ufo, const EntityStore &entities) {
+        ufoPosition = ufo.getPosition();
+        ufoPreviousPosition = ufo.getPreviousPosition();
+        x.assign(entities.x.begin(), entities.x.end());
+        y.assign(entities.y.begin(), entities.y.end());
+        previousX.assign(entities.previousX.begin(), entities.previousX.end());
+        previousY.assign(entities.previousY.begin(), entities.previousY.end());
+        kind.assign(entities.kind.begin(), entities.kind.end());
+    }
+
+    std::size_t size() const {
+        return x.size();
+    }
 
-    // Konstruktor poziomu inicjalizujący wszystkie parametry
-    Level(sf::Color bgColor, float speed, int obstacles)
-        : backgroundColor(bgColor), obstacleSpeed(speed), numObstacles(obstacles) {}
-};
+    // Pozycje interpolowane między dwoma ostatnimi krokami symulacji
+    sf::Vector2f getInterpolatedPosition(std::size_t i, float alpha) const {
+        return sf::Vector2f(previousX[i] + (x[i] - previousX[i]) * alpha, previousY[i] + (y[i] - previousY[i]) * alpha);
+    }
 
-// Inicjalizacja statycznej tekstury dla klasy Obstacle
-sf::Texture Obstacle::texture;
+    sf::Vector2f getInterpolatedUfoPosition(float alpha) const {
+        return ufoPreviousPosition + (ufoPosition - ufoPreviousPosition) * alpha;
+    }
+};
 
 // Klasa zarządzająca różnymi ekranami gry (menu, gra, koniec gry)
 class ScreenManager {
@@ -426,22 +3910,18 @@ public:
 
 private:
     ScreenType currentScreen;   // Aktualnie wyświetlany ekran
-    sf::Font font;             // Czcionka używana do wyświetlania tekstów
-    sf::Text endeText;         // Tekst wyświetlany na ekranie końca gry
-    sf::Text losText;          // Tekst wyświetlany w menu
+    BitmapText endeText;       // Tekst wyświetlany na ekranie końca gry
+    BitmapText losText;        // Tekst wyświetlany w menu
+    SpriteBatch spriteBatch;   // Partie sprite'ów ekranu gry (jedna na teksturę)
+    TextBatch textBatch;       // Cały tekst klatki w jednym wywołaniu draw
 
     // Inicjalizacja ekranu końca gry
     // Konfiguruje tekst, czcionkę i pozycję dla ekranu "Ende"
     // Parametry:
     // - windowSize: rozmiar okna gry do wycentrowania tekstu
     void initEndeScreen(const sf::Vector2f &windowSize) {
-        // Ładowanie czcionki
-        if (!font.loadFromFile("arial.ttf")) {
-            throw std::runtime_error("Nie można załadować pliku czcionki");
-        }
-
         // Konfiguracja tekstu końca gry
-        endeText.setFont(font);
+        endeText.setFont(getUiFont());
         endeText.setString("Ende\n\nESC - koniec rozgrywki\n\n G - Kontynucja");
         endeText.setCharacterSize(50);
         endeText.setFillColor(sf::Color::Red);
@@ -456,14 +3936,9 @@ private:
 
     // Inicjalizacja ekranu menu
     void initLosScreen(const sf::Vector2f &windowSize) {
-        // Ładowanie czcionki
-        if (!font.loadFromFile("arial.ttf")) {
-            throw std::runtime_error("Nie można załadować pliku czcionki");
-        }
-
         // Konfiguracja tekstu menu
-        losText.setFont(font);
-        losText.setString("Menu\n\nGra polega na pomijaniu innych statkow kosmiczych \n\nprzy jednoczesnym zbieraniu monet\n\nReturn - Zmiana poziomow\n\nF1 - Pomoc\n\nESC - Koniec gry\n\nS - Zapis gry\n\nF - Przywrocenie ostatniego zapisu");
+        losText.setFont(getUiFont());
+        losText.setString("Menu\n\nGra polega na pomijaniu innych statkow kosmiczych \n\nprzy jednoczesnym zbieraniu monet\n\nReturn - Zmiana poziomow\n\nF1 - Pomoc\n\nESC - Koniec gry\n\nS - Zapis gry\n\nF - Przywrocenie ostatniego zapisu\n\nF3 - Profiler, F4 - Zapis profilu");
         losText.setCharacterSize(30);
         losText.setFillColor(sf::Color::Blue);
 
@@ -478,7 +3953,7 @@ private:
 public:
     // Konstruktor inicjalizujący menedżera ekranów
     ScreenManager(const sf::Vector2f &windowSize)
-        : currentScreen(ScreenType::Game) {
+        : currentScreen(ScreenType::Game), textBatch(getUiFont()) {
         initEndeScreen(windowSize);
         initLosScreen(windowSize);
     }
@@ -493,63 +3968,736 @@ public:
         return currentScreen;
     }
 
+    // Liczba wywołań draw dla sprite'ów w ostatniej klatce ekranu gry
+    std::size_t getDrawCallCount() const {
+        return spriteBatch.getDrawCallCount();
+    }
+
     // Rysowanie odpowiedniego ekranu w zależności od aktualnego stanu
-    void draw(sf::RenderWindow &window, Interfejs &interfejs, Ufo &ufo, const std::vector<Obstacle> &obstacles, const std::vector<Reward> &rewards) {
+    // alpha - ułamek kroku symulacji, który upłynął od ostatniej aktualizacji (do interpolacji pozycji)
+    void draw(sf::RenderWindow &window, Interfejs &interfejs, const WorldSnapshot &world, float alpha) {
         if (currentScreen == ScreenType::Game) {
             // Rysowanie ekranu gry ze wszystkimi elementami
-            interfejs.draw(window);
-            for (const auto &obstacle : obstacles) {
-                obstacle.draw(window);
-            }
-            for (const auto &reward : rewards) {
-                reward.draw(window);
+            interfejs.drawBackground(window);
+
+            // Przeszkody, nagrody i UFO - jedno wywołanie draw na teksturę
+            spriteBatch.clear();
+            for (std::size_t i = 0; i < world.size(); ++i) {
+                const sf::Vector2f position = world.getInterpolatedPosition(i, alpha);
+                if (world.kind[i] == EntityKind::Obstacle) {
+                    Obstacle::draw(spriteBatch, position.x, position.y);
+                } else {
+                    Reward::draw(spriteBatch, position.x, position.y);
+                }
             }
-            ufo.draw(window);
+            const sf::Vector2f ufoPosition = world.getInterpolatedUfoPosition(alpha);
+            Ufo::draw(spriteBatch, ufoPosition.x, ufoPosition.y);
+            spriteBatch.draw(window);
+
+            // Napisy interfejsu na wierzchu
+            textBatch.clear();
+            interfejs.addText(textBatch);
+            textBatch.draw(window);
         } else if (currentScreen == ScreenType::Ende) {
             // Rysowanie ekranu końca gry
             window.clear(sf::Color::Black);
-            window.draw(endeText);
+            textBatch.clear();
+            textBatch.add(endeText);
+            textBatch.draw(window);
         } else if (currentScreen == ScreenType::Los) {
             // Rysowanie ekranu menu
             window.clear(sf::Color::Black);
-            window.draw(losText);
+            textBatch.clear();
+            textBatch.add(losText);
+            textBatch.draw(window);
         }
     }
 };
 
 
-int main() {
-    try {
-        // Kontener do przechowywania danych gry
+// Mikrobenchmark kernela obiektów: ./prog --bench-kernel [liczba_obiektów] [liczba_kroków]
+// Porównuje dawną ścieżkę (osobny sf::Sprite na obiekt, getPosition/getGlobalBounds) z wariantami kernela
+void runEntityKernelBenchmark(std::size_t count, int steps) {
+    const sf::FloatRect bounds(0.f, 50.f, 1200.f, 650.f);
+    const sf::FloatRect ufoBounds(575.f, 350.f, 50.f, 50.f);
+    const float deltaTime = 1.f / 120.f;
+
+    // Obiekty rozłożone deterministycznie po całym obszarze gry
+    EntityStore initial;
+    initial.setCapacity(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        float x = bounds.left + static_cast<float>((i * 7919) % static_cast<std::size_t>(bounds.width));
+        float y = bounds.top + static_cast<float>((i * 104729) % static_cast<std::size_t>(bounds.height - 40.f));
+        initial.add(i % 4 == 0 ? EntityKind::Reward : EntityKind::Obstacle, x, y, 100.f + static_cast<float>(i % 5) * 25.f, sf::Vector2f(40.f, 40.f));
+    }
+
+    // Dawna ścieżka: obiekt na obiekt, pozycja czytana z transformacji sprite'a
+    struct SpriteEntity {
+        sf::Sprite sprite;
+        float speed;
+    };
+    std::vector<SpriteEntity> sprites(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        sprites[i].sprite.setTextureRect(sf::IntRect(0, 0, 40, 40));
+        sprites[i].sprite.setPosition(initial.x[i], initial.y[i]);
+        sprites[i].speed = -initial.velocityX[i];
+    }
+
+    std::size_t checksum = 0;
+    sf::Clock clock;
+    for (int step = 0; step < steps; ++step) {
+        for (auto &entity : sprites) {
+            sf::Vector2f position = entity.sprite.getPosition();
+            position.x -= entity.speed * deltaTime;
+            if (position.x + entity.sprite.getGlobalBounds().width < bounds.left) {
+                position.x = bounds.left + bounds.width;
+            }
+            entity.sprite.setPosition(position);
+            checksum += ufoBounds.intersects(entity.sprite.getGlobalBounds()) ? 1 : 0;
+        }
+    }
+    const double perObjectNs = clock.restart().asMicroseconds() * 1000.0 / (static_cast<double>(count) * steps);
+    std::cout << "sf::Sprite na obiekt: " << perObjectNs << " ns/obiekt (trafienia: " << checksum << ")" << std::endl;
+
+    // Warianty kernela na tych samych danych; wyniki muszą być identyczne
+    std::vector<EntityKernel> kernels = {entityKernelScalar};
+#ifdef SPACEGAME_X86_KERNELS
+    kernels.push_back(entityKernelSse);
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(entityKernelAvx2);
+    }
+#endif
+    std::vector<float> referenceX;
+    for (EntityKernel kernel : kernels) {
+        EntityStore entities = initial;
+        std::vector<std::uint64_t> wrapped(entityMaskWords(count));
+        std::vector<std::uint64_t> hits(entityMaskWords(count));
+        EntityKernelInput input = {entities.x.data(), entities.y.data(), entities.velocityX.data(),
+                                   entities.width.data(), entities.height.data(), count};
+
+        std::size_t kernelHits = 0;
+        clock.restart();
+        for (int step = 0; step < steps; ++step) {
+            kernel(input, deltaTime, bounds.left, ufoBounds, wrapped.data(), hits.data());
+            forEachSetBit(wrapped, [&](std::size_t i) { entities.x[i] = bounds.left + bounds.width; });
+            for (std::uint64_t word : hits) {
+                kernelHits += static_cast<std::size_t>(__builtin_popcountll(word));
+            }
+        }
+        const double kernelNs = clock.restart().asMicroseconds() * 1000.0 / (static_cast<double>(count) * steps);
+
+        if (referenceX.empty()) {
+            referenceX = entities.x;
+        }
+        const bool matches = kernelHits == checksum && entities.x == referenceX;
+        std::cout << "Kernel " << entityKernelName(kernel) << ": " << kernelNs << " ns/obiekt, x"
+                  << (kernelNs > 0 ? perObjectNs / kernelNs : 0.0) << (matches ? "" : " - WYNIKI RÓŻNE!") << std::endl;
+    }
+}
+
+// Potrójny bufor z wymianą bez blokad: producent zawsze ma wolny bufor do zapisu,
+// konsument zawsze czyta najnowszy opublikowany, żaden z nich nie czeka na drugiego
+template <typename T>
+class TripleBuffer {
+private:
+    static constexpr std::uint8_t indexMask = 3;
+    static constexpr std::uint8_t freshBit = 4;  // Środkowy bufor zawiera nieodebraną publikację
+
+    std::array<T, 3> buffers;
+    std::atomic<std::uint8_t> middle{1};
+    std::uint8_t back = 0;   // Używany tylko przez producenta
+    std::uint8_t front = 2;  // Używany tylko przez konsumenta
+
+public:
+    // Bufor do wypełnienia przez producenta
+    T &writeBuffer() {
+        return buffers[back];
+    }
+
+    // Oddanie wypełnionego bufora konsumentowi
+    void publish() {
+        back = middle.exchange(static_cast<std::uint8_t>(back | freshBit), std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Przejęcie najnowszej publikacji; false, jeśli od ostatniego razu nic nowego nie przyszło
+    bool acquire() {
+        if (!(middle.load(std::memory_order_acquire) & freshBit)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T &readBuffer() const {
+        return buffers[front];
+    }
+};
+
+// Migawka wszystkiego, czego wątek renderujący potrzebuje do narysowania klatki
+// (same dane, bez obiektów SFML - te należą wyłącznie do wątku renderującego)
+struct RenderSnapshot {
+    ScreenManager::ScreenType screen = ScreenManager::ScreenType::Game;
+    sf::Color backgroundColor = sf::Color::Black;
+    WorldSnapshot world;
+    float alpha = 0.f;                 // Ułamek kroku symulacji do interpolacji
+    int score = 0;
+    InterfejsState overlays;
+    bool gameOver = false;
+    std::string profilerReport;
+    unsigned resizeCount = 0;          // Zmiana licznika unieważnia warstwę statyczną
+    bool allocationCheck = false;      // Ustalona klatka - rysowanie też nie może alokować na stercie
+    bool strictAllocationCheck = false;
+
+    // Pojemność na raport profilera z góry - kopiowanie raportu do migawki nie alokuje w trakcie gry
+    RenderSnapshot() {
+        profilerReport.reserve(1024);
+    }
+};
+
+// Wątek renderujący: rysuje najnowszą migawkę stanu i wywołuje display(), więc przestoje GPU
+// nie opóźniają kroków symulacji. Interfejs i ekrany są tworzone i używane tylko w tym wątku
+class RenderThread {
+private:
+    sf::RenderWindow &window;
+    sf::Vector2f windowSize;
+    const sf::Clock &startupClock;
+    TripleBuffer<RenderSnapshot> snapshots;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> ready{false};       // Interfejs i ekrany utworzone (zasoby przejęte)
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex wakeMutex;                 // Tylko do usypiania wątku, producent go nie blokuje
+    std::condition_variable wakeCondition;
+    std::atomic<bool> snapshotPending{false};
+    std::mutex displayMutex;
+    std::condition_variable displayCondition;
+    std::uint64_t displayedFrames = 0;    // Liczba wywołań display() (pod displayMutex)
+    std::uint64_t lastWaitedFrame = 0;    // Wartość displayedFrames przy ostatnim waitForDisplay()
+    std::atomic<std::size_t> spriteDrawCalls{0};  // Do nakładki profilera w wątku gry
+    std::thread thread;
+
+    void run() {
+        profilerThreadId = 2;
+        window.setActive(true);
+        try {
+            Interfejs interfejs(windowSize);
+            ScreenManager screenManager(windowSize);
+            // Atlas powstaje tutaj, póki loader trzyma zdekodowane obrazy (po ready są zwalniane)
+            getGameAtlas();
+            ready.store(true);
+            unsigned resizeCount = 0;
+            bool gameOverShown = false;
+            bool firstFrameShown = false;
+            unsigned quietFrames = 0;
+            bool allocationWarningShown = false;
+
+            while (!stopRequested.load()) {
+                {
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    wakeCondition.wait_for(lock, std::chrono::milliseconds(20), [this] {
+                        return snapshotPending.load() || stopRequested.load();
+                    });
+                    snapshotPending.store(false);
+                }
+                if (!snapshots.acquire()) {
+                    continue;
+                }
+                const RenderSnapshot &snapshot = snapshots.readBuffer();
+                const std::uint64_t frameAllocationStart = heapAllocationCount;
+
+                // Przeniesienie stanu z migawki do elementów interfejsu
+                {
+                    ProfileScope scope(ProfilePhase::UpdateTexts);
+                    interfejs.updateTexts(snapshot.world.ufoPosition, snapshot.score);
+                    interfejs.setOverlays(snapshot.overlays);
+                    interfejs.setBackgroundColor(snapshot.backgroundColor);
+                    if (snapshot.overlays.isProfilerVisible()) {
+                        interfejs.setProfilerReport(snapshot.profilerReport);
+                    }
+                    if (snapshot.resizeCount != resizeCount) {
+                        interfejs.invalidateStaticLayer();
+                        resizeCount = snapshot.resizeCount;
+                    }
+                    if (snapshot.gameOver && !gameOverShown) {
+                        interfejs.showGameOver();
+                    }
+                    gameOverShown = snapshot.gameOver;
+                    screenManager.switchTo(snapshot.screen);
+                }
+
+                {
+                    ProfileScope scope(ProfilePhase::Draw);
+                    window.clear(snapshot.backgroundColor);
+                    screenManager.draw(window, interfejs, snapshot.world, snapshot.alpha);
+                    spriteDrawCalls.store(screenManager.getDrawCallCount(), std::memory_order_relaxed);
+                }
+                {
+                    ProfileScope scope(ProfilePhase::Display);
+                    window.display();
+                }
+                {
+                    std::lock_guard<std::mutex> lock(displayMutex);
+                    ++displayedFrames;
+                }
+                displayCondition.notify_all();
+
+                // Kontrola alokacji rysowania w klatkach, które wątek gry uznał za ustalone
+                quietFrames = snapshot.allocationCheck ? quietFrames + 1 : 0;
+                const std::uint64_t frameAllocations = heapAllocationCount - frameAllocationStart;
+                if (quietFrames > allocationWarmupFrames && frameAllocations > 0) {
+                    reportSteadyFrameAllocations("wątek renderujący", frameAllocations, snapshot.strictAllocationCheck,
+                                                 allocationWarningShown);
+                }
+
+                if (!firstFrameShown && snapshot.screen == ScreenManager::ScreenType::Game) {
+                    std::cout << "Pierwsza klatka gry po " << startupClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+                    firstFrameShown = true;
+                }
+            }
+        } catch (...) {
+            error = std::current_exception();
+            failed.store(true);
+        }
+        window.setActive(false);
+    }
+
+public:
+    // Okno musi być wcześniej zdezaktywowane w wątku gry (setActive(false))
+    RenderThread(sf::RenderWindow &renderWindow, const sf::Vector2f &size, const sf::Clock &clock)
+        : window(renderWindow), windowSize(size), startupClock(clock), thread(&RenderThread::run, this) {}
+
+    ~RenderThread() {
+        stop();
+    }
+
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    // Migawka do wypełnienia przez wątek gry
+    RenderSnapshot &beginSnapshot() {
+        return snapshots.writeBuffer();
+    }
+
+    void publishSnapshot() {
+        snapshots.publish();
+        snapshotPending.store(true);
+        wakeCondition.notify_one();
+    }
+
+    // Zatrzymanie wątku (przed zamknięciem okna)
+    void stop() {
+        if (thread.joinable()) {
+            stopRequested.store(true);
+            wakeCondition.notify_one();
+            thread.join();
+        }
+    }
+
+    bool isReady() const {
+        return ready.load();
+    }
+
+    std::size_t getSpriteDrawCalls() const {
+        return spriteDrawCalls.load(std::memory_order_relaxed);
+    }
+
+    // Tryb VSync: wątek gry czeka na kolejne display(), więc robi tyle klatek, ile odświeżeń ma monitor
+    // (60, 120, 144 Hz...). Limit czasu - na wypadek, gdy wątek renderujący nie ma czego rysować
+    void waitForDisplay() {
+        std::unique_lock<std::mutex> lock(displayMutex);
+        displayCondition.wait_for(lock, std::chrono::milliseconds(100), [this] {
+            return displayedFrames != lastWaitedFrame || stopRequested.load();
+        });
+        lastWaitedFrame = displayedFrames;
+    }
+
+    // Błąd wątku renderującego (np. brak pliku zasobu) jest rzucany w wątku gry
+    void rethrowIfFailed() {
+        if (failed.load()) {
+            stop();
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Tryby tempa klatek
+enum class FramePacingMode {
+    VSync,      // Synchronizacja pionowa - display() czeka na odświeżenie monitora
+    Limit,      // Własny limit klatek na sekundę (uśpienie, a końcówka w aktywnym oczekiwaniu)
+    Unlimited   // Bez ograniczeń (do pomiarów)
+};
+
+// Tempo klatek: pętla gry nie renderuje więcej klatek, niż potrzeba
+class FramePacer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Końcówka oczekiwania krótsza niż to jest kręcona w pętli, bo uśpienie bywa spóźnione o ułamek milisekundy
+    static constexpr std::chrono::microseconds spinThreshold{500};
+
+    FramePacingMode mode;
+    Clock::duration framePeriod;
+    Clock::time_point nextFrame = Clock::now();
+
+public:
+    FramePacer(FramePacingMode pacingMode, unsigned framesPerSecond)
+        : mode(pacingMode),
+          framePeriod(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / std::max(framesPerSecond, 1u)))) {}
+
+    // Ustawienie okna zgodnie z trybem (limit SFML jest wyłączony - ma dokładność tylko do milisekundy)
+    void apply(sf::RenderWindow &window) const {
+        window.setVerticalSyncEnabled(mode == FramePacingMode::VSync);
+        window.setFramerateLimit(0);
+    }
+
+    // Po przerwie (np. po czekaniu na zdarzenie) odliczanie zaczyna się od nowa
+    void reset() {
+        nextFrame = Clock::now();
+    }
+
+    // Czekanie do początku kolejnej klatki wątku gry według limitu klatek
+    // W trybie VSync tempo wyznacza monitor - wątek gry czeka na display() (RenderThread::waitForDisplay)
+    void waitForNextFrame() {
+        if (mode != FramePacingMode::Limit) {
+            return;
+        }
+        nextFrame += framePeriod;
+        Clock::time_point now = Clock::now();
+        if (nextFrame < now) {
+            // Klatka się spóźniła - bez nadrabiania serią klatek bez przerwy
+            nextFrame = now;
+            return;
+        }
+        if (nextFrame - now > spinThreshold) {
+            std::this_thread::sleep_for(nextFrame - now - spinThreshold);
+        }
+        while (Clock::now() < nextFrame) {
+            std::this_thread::yield();
+        }
+    }
+
+    FramePacingMode getMode() const {
+        return mode;
+    }
+};
+
+// Ekran ładowania: pasek postępu rysowany, dopóki zasoby wczytują się w tle
+// Zwraca false, jeśli gracz zamknął okno w trakcie ładowania
+bool runLoadingScreen(sf::RenderWindow &window, AsyncAssetLoader &loader, const sf::Clock &startupClock) {
+    const sf::Vector2f windowSize(window.getSize());
+    sf::RectangleShape frame(sf::Vector2f(windowSize.x / 2, 20.f));
+    frame.setPosition(windowSize.x / 4, windowSize.y / 2 - 10.f);
+    frame.setFillColor(sf::Color::Transparent);
+    frame.setOutlineThickness(1.f);
+    frame.setOutlineColor(sf::Color::White);
+    sf::RectangleShape bar;
+    bar.setPosition(frame.getPosition());
+    bar.setFillColor(sf::Color::Yellow);
+
+    bool firstFrameShown = false;
+    while (true) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                window.close();
+            }
+        }
+        const bool done = loader.isDone();
+
+        bar.setSize(sf::Vector2f(frame.getSize().x * loader.getProgress(), frame.getSize().y));
+        window.clear(sf::Color::Black);
+        window.draw(frame);
+        window.draw(bar);
+        window.display();
+
+        if (!firstFrameShown) {
+            std::cout << "Pierwsza klatka (ekran ładowania) po " << startupClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+            firstFrameShown = true;
+        }
+        if (done || !window.isOpen()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    loader.wait();
+    std::cout << "Zasoby wczytane po " << startupClock.getElapsedTime().asMilliseconds() << " ms ("
+              << getAssetCache().getLoadCount() << " plików z dysku)" << std::endl;
+    return window.isOpen();
+}
+
+// Odtwarzanie nagrania z maksymalną szybkością; z render == true także w oknie gry
+// Zwraca kod wyjścia programu: 0 gdy skróty stanu zgadzają się we wszystkich krokach
+int runReplay(const std::string &filename, bool render) {
+    ReplayPlayer player(filename);
+    sf::Clock clock;
+
+    if (!render) {
+        while (player.advance()) {
+        }
+    } else {
+        sf::Clock startupClock;
+        const sf::Vector2f windowSize(1200, 750);
+        sf::RenderWindow window(sf::VideoMode(static_cast<unsigned int>(windowSize.x), static_cast<unsigned int>(windowSize.y)), "Space Game - odtwarzanie");
+        window.setVerticalSyncEnabled(false);
+        std::vector<std::string> imageFiles = gameSpriteFiles;
+        imageFiles.push_back(backgroundFile);
+        AsyncAssetLoader assetLoader(imageFiles, std::vector<std::string>{uiFontFile});
+        if (!runLoadingScreen(window, assetLoader, startupClock)) {
+            return 0;
+        }
+        window.setActive(false);
+        RenderThread renderThread(window, windowSize, startupClock);
+
+        // Jeden krok na obieg pętli; wątek renderujący rysuje najnowszą migawkę, pozostałe pomija
+        clock.restart();
+        bool running = true;
+        while (running) {
+            renderThread.rethrowIfFailed();
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    running = false;
+                }
+            }
+            running = running && player.advance();
+
+            RenderSnapshot &snapshot = renderThread.beginSnapshot();
+            snapshot.world.capture(player.simulation.ufo, player.simulation.entities);
+            snapshot.alpha = 1.f;
+            snapshot.score = player.simulation.score;
+            snapshot.gameOver = player.simulation.isGameOver;
+            renderThread.publishSnapshot();
+        }
+        renderThread.stop();
+        window.close();
+    }
+
+    const double seconds = std::max(clock.getElapsedTime().asMicroseconds(), sf::Int64(1)) / 1e6;
+    std::cout << "Odtworzono " << player.ticks << " kroków (" << static_cast<long long>(player.ticks / seconds)
+              << " kroków/s), wynik: " << player.simulation.score << std::endl;
+    if (player.firstMismatch != 0) {
+        std::cout << "Nagranie NIEZGODNE - pierwsza rozbieżność w kroku " << player.firstMismatch << std::endl;
+        return 1;
+    }
+    std::cout << "Nagranie zgodne" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Tryb offline: zwinięcie dziennika do snapshotu bez uruchamiania gry
+    if (argc > 1 && std::string(argv[1]) == "--compact") {
+        ScoreStore(scoreSnapshotFile, scoreJournalFile, scoreIndexFile).compact();
+        return 0;
+    }
+
+    // Pomiar przepustowości symulacji bez okna i tekstur
+    if (argc > 1 && std::string(argv[1]) == "--headless") {
+        std::string counts = argc > 2 ? argv[2] : "1000,10000,100000";
+        int ticks = 1200;
+        std::uint64_t seed = 1;
+        if ((argc > 3 && !parseNumberArgument(argv[3], ticks)) || (argc > 4 && !parseNumberArgument(argv[4], seed))) {
+            std::cerr << "Użycie: --headless [liczby_obiektów] [kroki] [ziarno]" << std::endl;
+            return 1;
+        }
+        try {
+            return runHeadlessBenchmark(counts, ticks, seed) ? 0 : 1;
+        } catch (const std::exception &e) {
+            std::cerr << "Wyjątek: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Odtworzenie nagranej sesji: ./prog --replay plik [--render]
+    if (argc > 2 && std::string(argv[1]) == "--replay") {
+        try {
+            return runReplay(argv[2], argc > 3 && std::string(argv[3]) == "--render");
+        } catch (const std::exception &e) {
+            std::cerr << "Wyjątek: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--bench-jobs") {
+        std::size_t count = 100000;
+        int steps = 200;
+        if ((argc > 2 && !parseNumberArgument(argv[2], count)) || (argc > 3 && !parseNumberArgument(argv[3], steps))) {
+            std::cerr << "Użycie: --bench-jobs [obiekty] [kroki]" << std::endl;
+            return 1;
+        }
+        try {
+            runJobSystemBenchmark(count, steps);
+        } catch (const std::exception &e) {
+            std::cerr << "Wyjątek: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--bench-kernel") {
+        std::size_t count = 100000;
+        int steps = 200;
+        if ((argc > 2 && !parseNumberArgument(argv[2], count)) || (argc > 3 && !parseNumberArgument(argv[3], steps))) {
+            std::cerr << "Użycie: --bench-kernel [obiekty] [kroki]" << std::endl;
+            return 1;
+        }
+        try {
+            runEntityKernelBenchmark(count, steps);
+        } catch (const std::exception &e) {
+            std::cerr << "Wyjątek: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // Lista najlepszych wyników: ./prog --top [liczba] (domyślnie tyle, ile trzyma indeks)
+    if (argc > 1 && std::string(argv[1]) == "--top") {
+        std::size_t count = indexTopScoreCount;
+        if (argc > 2 && !parseNumberArgument(argv[2], count)) {
+            std::cerr << "Użycie: --top [liczba]" << std::endl;
+            return 1;
+        }
+        ScoreStore store(scoreSnapshotFile, scoreJournalFile, scoreIndexFile);
+        for (const auto& gameData : store.topScores(count)) {
+            std::cout << gameData.score << "\t" << formatDate(gameData.date) << std::endl;
+        }
+        return 0;
+    }
+
+    // Zapisy z podanego przedziału dat (np. --range "2025-01-01" "2025-02-01 12:00")
+    if (argc > 3 && std::string(argv[1]) == "--range") {
+        std::int64_t from = 0;
+        std::int64_t to = 0;
+        try {
+            from = parseDate(argv[2]);
+            to = parseDate(argv[3]);
+        } catch (const std::exception& e) {
+            std::cerr << "Błędny zakres dat: " << e.what() << std::endl;
+            return 1;
+        }
+        ScoreStore store(scoreSnapshotFile, scoreJournalFile, scoreIndexFile);
+        for (const auto& gameData : store.inDateRange(from, to)) {
+            std::cout << gameData.score << "\t" << formatDate(gameData.date) << std::endl;
+        }
+        return 0;
+    }
+
+    // Eksport/import historii zapisów w formacie JSON
+    if (argc > 2 && std::string(argv[1]) == "--export-json") {
+        std::vector<GameData> gameDataList;
+        if (!loadScoreHistory(scoreSnapshotFile, scoreJournalFile, gameDataList)) {
+            return 1;
+        }
+        saveScoreToJson(argv[2], gameDataList);
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--import-json") {
         std::vector<GameData> gameDataList;
-        // Inicjalizacja generatora liczb losowych
-        srand(static_cast<unsigned int>(time(nullptr)));
+        std::vector<GameData> imported;
+        if (!loadScoreHistory(scoreSnapshotFile, scoreJournalFile, gameDataList) || !loadScoreFromJson(argv[2], imported)) {
+            return 1;
+        }
+        removeLegacyDuplicates(imported);
+        gameDataList.insert(gameDataList.end(), imported.begin(), imported.end());
+        if (!saveScoreSnapshot(scoreSnapshotFile, gameDataList)) {
+            return 1;
+        }
+        std::ofstream(scoreJournalFile, std::ios::trunc);
+        return 0;
+    }
+
+    // Tempo klatek: domyślnie limit 60 klatek/s; --vsync albo --fps N (0 - bez limitu)
+    FramePacingMode pacingMode = FramePacingMode::Limit;
+    unsigned framesPerSecond = 60;
+    // Ziarno sesji: --seed N odtwarza rozmieszczenie obiektów z zapisanej gry
+    // --record plik zapisuje wejście całej sesji do późniejszego odtworzenia (--replay)
+    // --strict-alloc: alokacja na stercie w ustalonej klatce rozgrywki kończy grę wyjątkiem zamiast ostrzeżenia
+    std::string recordFile;
+    bool strictAllocationCheck = false;
+    std::uint64_t sessionSeed = static_cast<std::uint64_t>(time(nullptr)) ^
+                                static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            if (!parseNumberArgument(argv[++i], sessionSeed)) {
+                std::cerr << "Użycie: --seed N (liczba całkowita nieujemna), podano: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (arg == "--strict-alloc") {
+            strictAllocationCheck = true;
+        } else if (arg == "--vsync") {
+            pacingMode = FramePacingMode::VSync;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            if (!parseNumberArgument(argv[++i], framesPerSecond)) {
+                std::cerr << "Użycie: --fps N (0 - bez limitu), podano: " << argv[i] << std::endl;
+                return 1;
+            }
+            pacingMode = framesPerSecond == 0 ? FramePacingMode::Unlimited : FramePacingMode::Limit;
+        }
+    }
+
+    try {
+        // Pomiar czasu do pierwszej klatki
+        sf::Clock startupClock;
+
+        std::cout << "Ziarno sesji: " << sessionSeed << std::endl;
+
+        // Dekodowanie obrazów i czcionki w tle, zanim okno będzie gotowe
+        std::vector<std::string> imageFiles = gameSpriteFiles;
+        imageFiles.push_back(backgroundFile);
+        auto assetLoader = std::make_unique<AsyncAssetLoader>(imageFiles, std::vector<std::string>{uiFontFile});
 
         // Tworzenie okna gry o określonych wymiarach
         sf::Vector2f windowSize(1200, 750);
         sf::RenderWindow window(sf::VideoMode(static_cast<unsigned int>(windowSize.x), static_cast<unsigned int>(windowSize.y)), "Space Game");
+        FramePacer framePacer(pacingMode, framesPerSecond);
+        framePacer.apply(window);
+        if (!runLoadingScreen(window, *assetLoader, startupClock)) {
+            return 0;
+        }
 
-        // Inicjalizacja interfejsu z rozmiarem okna i ustawienie początkowego tekstu pozycji
-        Interfejs interfejs(windowSize);
-        interfejs.setText("Pozycja: (0, 0)", 10);
-
-        // Pobranie centralnych granic dla obszaru gry i utworzenie UFO na środku
-        sf::FloatRect centralBounds = interfejs.getCentralBounds();
-        Ufo ufo(centralBounds.left + centralBounds.width / 2 - 25.f, centralBounds.top + centralBounds.height / 2 - 25.f);
+        // Logika gry w obszarze centralnym; UFO startuje na środku
+        // Rozmiary obiektów pochodzą z obrazów trzymanych przez loader - atlas tworzy dopiero wątek renderujący
+        Simulation simulation(Interfejs::getCentralBounds(windowSize), getSpriteImageSize(Ufo::spriteFile),
+                              getSpriteImageSize(Obstacle::spriteFile), getSpriteImageSize(Reward::spriteFile), sessionSeed);
+        simulation.profiled = true;
+        // Pula wątków startuje przed pętlą gry - bez limitu klatek pierwszy krok symulacji
+        // przypada już po rozgrzewce licznika alokacji
+        getJobSystem();
 
-        // Inicjalizacja wyniku
-        int score = 0;
+        // Symulacja w stałych krokach 120 Hz niezależnie od liczby klatek rysowanych na sekundę
+        const float simulationStep = 1.f / 120.f;
 
-        // Próba wczytania zapisanych danych gry z pliku JSON
-        try {
-            sf::Vector2f loadedPosition = ufo.getPosition();
-            loadScoreFromJson("sscore.json", gameDataList, loadedPosition, score);
-            ufo.setPosition(loadedPosition);
-            std::cout << "Dane gry załadowane z pliku JSON." << std::endl;
-        } catch (const std::exception &e) {
-            std::cerr << "Błąd ładowania danych gry: " << e.what() << ". Gra rozpocznie się z domyślnymi ustawieniami." << std::endl;
+        InputRecorder recorder;
+        if (!recordFile.empty()) {
+            recorder.open(recordFile, simulation, simulationStep);
         }
 
+        // Stan interfejsu i aktualny ekran - po stronie wątku gry
+        InterfejsState interfejs;
+        ScreenManager::ScreenType currentScreen = ScreenManager::ScreenType::Game;
+        unsigned resizeCount = 0;
+
+        // Serwis zapisów z własnym wątkiem I/O - pętla gry nigdy nie czeka na dysk
+        PersistenceService persistence(scoreSnapshotFile, scoreJournalFile, scoreIndexFile);
+
+        // Przywrócenie ostatniego zapisu po zakończeniu wczytywania w tle
+        auto restoreLastSave = [&](const PersistenceResult &result) {
+            if (!result.hasGameData) {
+                std::cerr << "Brak zapisanych danych gry. Gra rozpocznie się z domyślnymi ustawieniami." << std::endl;
+                return;
+            }
+            simulation.ufo.setPosition(result.gameData.position);
+            simulation.score = result.gameData.score;
+            recorder.recordRestore(result.gameData.position, result.gameData.score);
+            std::cout << "Dane gry zostały załadowane." << std::endl;
+        };
+
+        // Próba wczytania zapisanych danych gry
+        persistence.loadLatest(restoreLastSave);
+
         // Definicja poziomów gry z różnymi właściwościami
         std::vector<Level> levels = {
             {sf::Color::Black, 100.f, 5},    // Poziom 1: Czarne tło,prędkość1 , mało przeszkód
@@ -559,91 +4707,124 @@ int main() {
         int currentLevelIndex = 0;
         Level currentLevel = levels[currentLevelIndex];
 
-        //inicjalizacja przeszkód dla aktualnego poziomu
-        std::vector<Obstacle> obstacles;
-        auto initializeObstacles = [&]() {
-            obstacles.clear();
-            for (int i = 0; i < currentLevel.numObstacles; ++i) {
-                float x = centralBounds.left + static_cast<float>(rand() % static_cast<int>(centralBounds.width));
-                float y = centralBounds.top + static_cast<float>(rand() % static_cast<int>(centralBounds.height));
-                obstacles.emplace_back(x, y, currentLevel.obstacleSpeed);
-            }
+        // Przeszkody i nagrody dla aktualnego poziomu
+        auto initializeEntities = [&]() {
+            simulation.initializeEntities(currentLevel.numObstacles, 3, currentLevel.obstacleSpeed);
+            recorder.recordSpawn(currentLevel.numObstacles, 3, currentLevel.obstacleSpeed);
         };
-        initializeObstacles();
+        initializeEntities();
+
+        sf::Clock clock;
+
+        const int maxStepsPerFrame = 8;       // Limit nadrabiania po dłuższej przerwie
+        const float maxFrameTime = 0.25f;     // Dłuższa klatka (np. przeciąganie okna) jest przycinana
+        float accumulator = 0.f;
 
-        //inicjalizacja nagród
-        std::vector<Reward> rewards;
-        auto initializeRewards = [&]() {
-            rewards.clear();
-            for (int i = 0; i < 3; ++i) {
-                float x = centralBounds.left + static_cast<float>(rand() % static_cast<int>(centralBounds.width));
-                float y = centralBounds.top + static_cast<float>(rand() % static_cast<int>(centralBounds.height));
-                rewards.emplace_back(x, y, currentLevel.obstacleSpeed / 2);
+        // Rysowanie w osobnym wątku; okno jest aktywowane tam, więc tutaj trzeba je zwolnić
+        window.setActive(false);
+        RenderThread renderThread(window, windowSize, startupClock);
+
+        // Jeden krok symulacji z wejściem z klawiatury; koniec gry przełącza ekran
+        auto simulateStep = [&](float deltaTime) {
+            const InputState input = readKeyboardInput();
+            const bool gameOverNow = simulation.step(deltaTime, input);
+            recorder.recordTick(input, simulation);
+            if (gameOverNow) {
+                currentScreen = ScreenManager::ScreenType::Ende;
             }
         };
-        initializeRewards();
 
-        // Zmienne stanu gry
-        bool isGameOver = false;
-        sf::Clock clock;
+        // Odświeżanie nakładki profilera kilka razy na sekundę (liczenie percentyli kosztuje)
+        FrameProfiler &profiler = getFrameProfiler();
+        sf::Clock profilerReportClock;
+        std::string profilerReport;
+        profilerReport.reserve(1024);
 
-        // Inicjalizacja menedżera ekranów dla różnych widoków gry
-        ScreenManager screenManager(windowSize);
+        // Kontrola alokacji: po kilku spokojnych klatkach rozgrywki klatka nie może alokować na stercie wątku gry
+        // ani wątku renderującego; kilka klatek rozgrzewki wystarcza, żeby bufory migawek urosły po zmianie poziomu.
+        // Pomijane są tylko alokacje wewnątrz pollEvent/waitEvent (SFML kolejkuje zdarzenia w kontenerach
+        // na stercie) - obsługa zdarzeń w grze jest sprawdzana jak reszta klatki
+        unsigned quietFrames = 0;
+        bool allocationWarningShown = false;
+        std::uint64_t eventAllocations = 0;
+        auto nextEvent = [&](sf::Event &event, bool wait) {
+            const std::uint64_t before = heapAllocationCount;
+            const bool hasEvent = wait ? window.waitEvent(event) : window.pollEvent(event);
+            eventAllocations += heapAllocationCount - before;
+            return hasEvent;
+        };
 
         // Główna pętla gry
         while (window.isOpen()) {
+            // Dane tymczasowe z poprzedniej klatki są zwalniane naraz
+            getFrameArena().reset();
+            const std::uint64_t frameAllocationStart = heapAllocationCount;
+            const bool callbacksPendingAtStart = persistence.hasPendingCallbacks();
+            bool traceExported = false;
+            bool frameHadInput = false;
+            eventAllocations = 0;
+
+            ProfileScope frameScope(ProfilePhase::Frame);
+            renderThread.rethrowIfFailed();
+
+            // Tekstury są już na karcie graficznej - obrazy źródłowe można zwolnić
+            if (assetLoader && renderThread.isReady()) {
+                assetLoader.reset();
+            }
+
+            // Na ekranach, na których nic się nie rusza (pomoc, pauza, koniec gry, menu), pętla czeka
+            // na zdarzenie zamiast rysować wciąż tę samą klatkę - chyba że czeka na wynik zapisu/wczytania
+            const bool idle = (currentScreen != ScreenManager::ScreenType::Game ||
+                               interfejs.isHelpVisible() || interfejs.isPauseVisible() || simulation.isGameOver) &&
+                              !persistence.hasPendingCallbacks() && !assetLoader;
+
             // Obsługa zdarzeń
+            ProfileScope eventsScope(ProfilePhase::Events);
             sf::Event event;
-            while (window.pollEvent(event)) {
+            bool hasEvent = nextEvent(event, idle);
+            if (idle) {
+                // Czas czekania nie jest czasem gry
+                clock.restart();
+                framePacer.reset();
+            }
+            for (; hasEvent; hasEvent = nextEvent(event, false)) {
                 if (event.type == sf::Event::Closed)
-                    window.close();
+                    interfejs.requestExit();
+
+                if (event.type == sf::Event::Resized) {
+                    ++resizeCount;
+                }
+                // Klawisz albo zmiana rozmiaru zmienia to, co rysuje wątek renderujący (nowe napisy, warstwy)
+                if (event.type == sf::Event::KeyPressed || event.type == sf::Event::Resized) {
+                    frameHadInput = true;
+                }
 
                 // Obsługa wejścia z klawiatury
                 if (event.type == sf::Event::KeyPressed) {
                     
                     if (event.key.code == sf::Keyboard::M) {
-                        if (screenManager.getCurrentScreen() == ScreenManager::ScreenType::Los) {
-                            screenManager.switchTo(ScreenManager::ScreenType::Game);
+                        if (currentScreen == ScreenManager::ScreenType::Los) {
+                            currentScreen = ScreenManager::ScreenType::Game;
                         } else {
-                            screenManager.switchTo(ScreenManager::ScreenType::Los);
+                            currentScreen = ScreenManager::ScreenType::Los;
                         }
                     }
                     
                     else if (event.key.code == sf::Keyboard::G) {
-                        if (screenManager.getCurrentScreen() == ScreenManager::ScreenType::Ende) {
-                            isGameOver = false;
-                            try {
-                                sf::Vector2f ufoPosition = ufo.getPosition();
-                                loadScoreFromJson("sscore.json", gameDataList, ufoPosition, score);
-                                ufo.setPosition(ufoPosition);
-                                interfejs.updateTexts(ufo.getPosition(), score);
-                                std::cout << "Dane gry zostały załadowane z pliku JSON." << std::endl;
-                            } catch (const std::exception &e) {
-                                std::cerr << "Błąd ładowania danych gry: " << e.what() << ". Gra rozpocznie się z domyślnymi ustawieniami." << std::endl;
-                            }
-                            initializeObstacles();
-                            initializeRewards();
-                            screenManager.switchTo(ScreenManager::ScreenType::Game);
+                        if (currentScreen == ScreenManager::ScreenType::Ende) {
+                            simulation.isGameOver = false;
+                            recorder.recordResume();
+                            persistence.loadLatest(restoreLastSave);
+                            initializeEntities();
+                            currentScreen = ScreenManager::ScreenType::Game;
                         }
                     }
                     
                     else if (event.key.code == sf::Keyboard::Escape) {
                         if (interfejs.isPauseVisible()) {
                             // Zapisywanie danych gry przed wyjściem
-                            GameData newGameData;
-                            newGameData.position = ufo.getPosition();
-                            newGameData.score = score;
-
-                            // Formatowanie i zapisywanie aktualnej daty
-                            auto now = std::time(nullptr);
-                            char buf[80];
-                            std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
-                            newGameData.date = buf;
-
-                            gameDataList.push_back(newGameData);
-                            saveScoreToJson("sscore.json", gameDataList);
-
-                            std::cout << "Dane gry zostały zapisane do pliku 'score.json'." << std::endl;
+                            // (serwis dokończy zapis przed zamknięciem wątku I/O)
+                            persistence.save(makeGameData(simulation.ufo.getPosition(), simulation.score, simulation.seed));
 
                             interfejs.requestExit();
                         } else {
@@ -660,96 +4841,116 @@ int main() {
                     else if (event.key.code == sf::Keyboard::F1) {
                         interfejs.toggleHelp();
                     }
+
+                    else if (event.key.code == sf::Keyboard::F3) {
+                        interfejs.toggleProfiler();
+                    }
+
+                    else if (event.key.code == sf::Keyboard::F4) {
+                        profiler.exportChromeTrace(profileTraceFile);
+                        traceExported = true;
+                    }
                     
                     else if (event.key.code == sf::Keyboard::Return) {
                         currentLevelIndex = (currentLevelIndex + 1) % levels.size();
                         currentLevel = levels[currentLevelIndex];
-                        initializeObstacles();
-                        initializeRewards();
+                        initializeEntities();
                         std::cout << "Poziom zmieniony na: " << currentLevelIndex + 1 << std::endl;
                     }
                     
                     else if (event.key.code == sf::Keyboard::F) {
-                        sf::Vector2f ufoPosition = ufo.getPosition();
-                        loadScoreFromJson("sscore.json", gameDataList, ufoPosition, score);
-                        ufo.setPosition(ufoPosition);
-                        interfejs.updateTexts(ufo.getPosition(), score);
-                        std::cout << "Dane gry zostały ponownie załadowane." << std::endl;
+                        persistence.loadLatest(restoreLastSave);
                     }
                     
                     else if (event.key.code == sf::Keyboard::S) {
-                        GameData newGameData;
-                        newGameData.position = ufo.getPosition();
-                        newGameData.score = score;
-
-                        auto now = std::time(nullptr);
-                        char buf[80];
-                        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
-                        newGameData.date = buf;
-
-                        gameDataList.push_back(newGameData);
-                        saveScoreToJson("sscore.json", gameDataList);
-
-                        std::cout << "Dane gry zostały zapisane do pliku 'score.json'." << std::endl;
+                        persistence.save(makeGameData(simulation.ufo.getPosition(), simulation.score, simulation.seed), [](const PersistenceResult &result) {
+                            if (result.ok) {
+                                std::cout << "Dane gry zostały zapisane do dziennika '" << scoreJournalFile << "'." << std::endl;
+                            }
+                        });
                     }
                 }
             }
 
-            // Obsługa wyjścia z gry
+            // Wyniki zapisów i wczytań zakończonych w tle
+            persistence.pollCompletions();
+
+            // Obsługa wyjścia z gry: najpierw zatrzymanie wątku renderującego, potem zamknięcie okna
             if (interfejs.isExitRequested()) {
-                saveScoreToJson("sscore.json", gameDataList);
+                renderThread.stop();
                 window.close();
+                break;
             }
+            eventsScope.stop();
 
             // Aktualizacja czasu gry
-            float deltaTime = clock.restart().asSeconds();
+            float frameTime = std::min(clock.restart().asSeconds(), maxFrameTime);
 
             // Aktualizacja logiki gry gdy jesteśmy na ekranie Game
-            if (screenManager.getCurrentScreen() == ScreenManager::ScreenType::Game) {
-                if (!interfejs.isHelpVisible() && !interfejs.isPauseVisible() && !isGameOver) {
-                    // Aktualizacja pozycji UFO
-                    ufo.update(deltaTime, centralBounds);
-
-                    // Sprawdzanie kolizji z przeszkodami
-                    for (auto &obstacle : obstacles) {
-                        obstacle.update(deltaTime, centralBounds);
-
-                        if (ufo.getBounds().intersects(obstacle.getBounds())) {
-                            static sf::Clock collisionClock;
-                            if (collisionClock.getElapsedTime().asMilliseconds() > 500) {
-                                score -= 1;
-                                collisionClock.restart();
-                                if (score < 0) {
-                                    screenManager.switchTo(ScreenManager::ScreenType::Ende);
-                                    isGameOver = true;
-                                    interfejs.showGameOver();
-                                    saveScoreToJson("sscore.json", gameDataList);
-                                }
-                            }
-                        }
+            // (na pauzie akumulator stoi, więc obraz się nie zmienia, a po wznowieniu nie ma nadrabiania)
+            if (currentScreen == ScreenManager::ScreenType::Game) {
+                if (!interfejs.isHelpVisible() && !interfejs.isPauseVisible() && !simulation.isGameOver) {
+                    accumulator += frameTime;
+                    int steps = 0;
+                    while (accumulator >= simulationStep && steps < maxStepsPerFrame && !simulation.isGameOver) {
+                        simulateStep(simulationStep);
+                        accumulator -= simulationStep;
+                        ++steps;
                     }
+                    // Zaległości ponad limit są porzucane zamiast spowalniać kolejne klatki
+                    if (steps == maxStepsPerFrame) {
+                        accumulator = std::min(accumulator, simulationStep);
+                    }
+                }
+            }
 
-                    // Sprawdzanie kolizji z nagrodami
-                    for (auto it = rewards.begin(); it != rewards.end();) {
-                        it->update(deltaTime, centralBounds);
+            if (interfejs.isProfilerVisible() && profilerReportClock.getElapsedTime().asSeconds() >= 0.25f) {
+                profiler.formatReport(profilerReport);
+                char drawCallsLine[48];
+                std::snprintf(drawCallsLine, sizeof(drawCallsLine), "Wywołania draw (sprite'y): %zu\n", renderThread.getSpriteDrawCalls());
+                profilerReport.append(drawCallsLine);
+                profilerReportClock.restart();
+            }
 
-                        if (ufo.getBounds().intersects(it->getBounds())) {
-                            score += 1;
-                            it = rewards.erase(it);
-                        } else {
-                            ++it;
-                        }
-                    }
+            // Klatka zlecająca zapis/wczytanie albo eksport śladu wykonuje I/O i nie jest ustalona
+            const bool steadyFrame = !idle && !callbacksPendingAtStart && !persistence.hasPendingCallbacks() && !traceExported &&
+                                     !assetLoader && renderThread.isReady();
+            quietFrames = steadyFrame ? quietFrames + 1 : 0;
 
-                    // Aktualizacja tekstu interfejsu
-                    interfejs.updateTexts(ufo.getPosition(), score);
-                }
+            // Migawka stanu dla wątku renderującego
+            {
+                ProfileScope scope(ProfilePhase::Snapshot);
+                RenderSnapshot &snapshot = renderThread.beginSnapshot();
+                snapshot.screen = currentScreen;
+                snapshot.backgroundColor = currentLevel.backgroundColor;
+                snapshot.world.capture(simulation.ufo, simulation.entities);
+                snapshot.alpha = accumulator / simulationStep;
+                snapshot.score = simulation.score;
+                snapshot.overlays = interfejs;
+                snapshot.gameOver = simulation.isGameOver;
+                snapshot.profilerReport = profilerReport;
+                snapshot.resizeCount = resizeCount;
+                snapshot.allocationCheck = steadyFrame && !frameHadInput;
+                snapshot.strictAllocationCheck = strictAllocationCheck;
+                renderThread.publishSnapshot();
+            }
+
+            const std::uint64_t frameAllocations = heapAllocationCount - frameAllocationStart - eventAllocations;
+            if (quietFrames > allocationWarmupFrames && frameAllocations > 0) {
+                reportSteadyFrameAllocations("wątek gry", frameAllocations, strictAllocationCheck, allocationWarningShown);
             }
 
-            // Renderowanie gry
-            window.clear(currentLevel.backgroundColor);
-            screenManager.draw(window, interfejs, ufo, obstacles, rewards);
-            window.display();
+            ProfileScope waitScope(ProfilePhase::FrameWait);
+            if (framePacer.getMode() == FramePacingMode::VSync) {
+                renderThread.waitForDisplay();
+            } else {
+                framePacer.waitForNextFrame();
+            }
+        }
+
+        // Błąd zapisu zamyka nagranie w trakcie gry - plik kończy się wcześniej niż rozgrywka
+        if (!recordFile.empty() && !recorder.isRecording()) {
+            std::cerr << "Nagranie " << recordFile << " jest niepełne (przerwane błędem zapisu)" << std::endl;
         }
 
     } catch (const std::exception &e) {
@@ -758,4 +4959,4 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,58 @@
+// Test importu starego zapisu JSON ("score 2.json" - daty bez godziny)
+// Budowanie i uruchomienie z katalogu głównego repozytorium:
+//   g++ -std=c++17 -I. tests/legacy_json_import_test.cpp -o import_test -lsfml-graphics -lsfml-window -lsfml-system -pthread
+//   ./import_test
+#define main spacegame_main
+#include "../spacegame.cpp"
+#undef main
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "BŁĄD: " << what << std::endl;
+        ++failures;
+    }
+}
+
+} // namespace
+
+int main() {
+    // Sama data to północ tego dnia (czas lokalny)
+    check(parseDate("2025-01-17") == parseDate("2025-01-17 00:00"), "data bez godziny = północ");
+    check(parseDate("2025-01-17 12:30:15") - parseDate("2025-01-17") == 12 * 3600 + 30 * 60 + 15, "data z godziną");
+    bool rejected = false;
+    try {
+        parseDate("2025-01-17 12");
+    } catch (const std::exception&) {
+        rejected = true;
+    }
+    check(rejected, "godzina bez minut jest odrzucana");
+
+    std::vector<GameData> gameDataList;
+    check(loadScoreFromJson("score 2.json", gameDataList), "import score 2.json");
+    check(gameDataList.size() == 4, "wszystkie 4 wpisy z score 2.json");
+    for (const GameData& gameData : gameDataList) {
+        check(gameData.date == parseDate("2025-01-17"), "data wpisu");
+        check(gameData.score == 10, "wynik wpisu");
+        check(gameData.position == sf::Vector2f(100.f, 200.f), "pozycja wpisu");
+    }
+
+    // Obcięty plik: wpisy sprzed błędu składni zostają, przerwany wpis i elementy niebędące obiektami są odrzucane
+    {
+        std::ofstream("import_test_truncated.json")
+            << R"({"games": [{"score": 5, "date": "2025-01-17", "position": [1, 2]}, 7, "x", [1], null,)"
+            << R"( {"score": 6, "date": "2025-01-18", "posi)";
+    }
+    std::vector<GameData> truncated;
+    check(loadScoreFromJson("import_test_truncated.json", truncated), "import obciętego pliku");
+    check(truncated.size() == 1 && truncated[0].score == 5, "wpis sprzed błędu składni");
+    std::remove("import_test_truncated.json");
+
+    if (failures == 0) {
+        std::cout << "OK" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
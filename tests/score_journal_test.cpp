@@ -0,0 +1,90 @@
+// Test dziennika zapisów: przerwany zapis na końcu dziennika, a po nim kolejny zapis;
+// kompaktowanie przerwane między podmianą snapshotu a wyczyszczeniem dziennika
+// Budowanie i uruchomienie z katalogu głównego repozytorium:
+//   g++ -std=c++17 -I. tests/score_journal_test.cpp -o journal_test -lsfml-graphics -lsfml-window -lsfml-system -pthread
+//   ./journal_test
+#define main spacegame_main
+#include "../spacegame.cpp"
+#undef main
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "BŁĄD: " << what << std::endl;
+        ++failures;
+    }
+}
+
+const std::string snapshotFile = "journal_test_snapshot.bin";
+const std::string journalFile = "journal_test_journal.bin";
+const std::string indexFile = "journal_test_index.idx";
+
+void removeTestFiles() {
+    std::remove(snapshotFile.c_str());
+    std::remove(journalFile.c_str());
+    std::remove(indexFile.c_str());
+}
+
+GameData testGameData(int score, std::int64_t date) {
+    GameData gameData = makeGameData(sf::Vector2f(10.f * score, 20.f), score, 7);
+    gameData.date = date;
+    return gameData;
+}
+
+} // namespace
+
+int main() {
+    removeTestFiles();
+
+    check(appendScoreToJournal(snapshotFile, journalFile, testGameData(1, 1000)), "pierwszy zapis");
+    check(appendScoreToJournal(snapshotFile, journalFile, testGameData(2, 2000)), "drugi zapis");
+
+    // Przerwany zapis: połowa rekordu na końcu pliku
+    {
+        std::FILE* file = std::fopen(journalFile.c_str(), "ab");
+        const char garbage[12] = {'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X', 'X'};
+        std::fwrite(garbage, sizeof(garbage), 1, file);
+        std::fclose(file);
+    }
+
+    check(appendScoreToJournal(snapshotFile, journalFile, testGameData(3, 3000)), "zapis po przerwanym zapisie");
+
+    std::vector<GameData> gameDataList;
+    loadScoreJournal(journalFile, gameDataList);
+    check(gameDataList.size() == 3, "trzy rekordy w dzienniku");
+    for (std::size_t i = 0; i < gameDataList.size(); ++i) {
+        const int score = static_cast<int>(i) + 1;
+        check(gameDataList[i].score == score, "wynik rekordu");
+        check(gameDataList[i].date == 1000 * score, "data rekordu");
+        check(gameDataList[i].position == sf::Vector2f(10.f * score, 20.f), "pozycja rekordu");
+    }
+
+    // Indeks zbudowany od nowa nie może widzieć śmieci jako najnowszego zapisu ani najlepszego wyniku
+    ScoreStore store(snapshotFile, journalFile, indexFile);
+    GameData latest;
+    check(store.latest(latest) && latest.score == 3 && latest.date == 3000, "najnowszy zapis");
+    const std::vector<GameData> top = store.topScores(indexTopScoreCount);
+    check(top.size() == 3 && top[0].score == 3, "najlepsze wyniki");
+
+    // Kompaktowanie przerwane po podmianie snapshotu: dziennik nie został wyczyszczony
+    std::vector<GameData> history;
+    check(loadScoreHistory(snapshotFile, journalFile, history) && history.size() == 3, "historia przed kompaktowaniem");
+    check(saveScoreSnapshot(snapshotFile, history), "snapshot z rekordami dziennika");
+    check(loadScoreHistory(snapshotFile, journalFile, history) && history.size() == 3, "dziennik nie jest wczytywany drugi raz");
+    ScoreStore reopened(snapshotFile, journalFile, indexFile);
+    check(reopened.topScores(indexTopScoreCount).size() == 3, "indeks bez podwojonych rekordów");
+
+    // Następny zapis zaczyna dziennik od nowa
+    check(appendScoreToJournal(snapshotFile, journalFile, testGameData(4, 4000)), "zapis po przerwanym kompaktowaniu");
+    check(loadScoreHistory(snapshotFile, journalFile, history) && history.size() == 4 && history.back().score == 4,
+          "historia po zapisie");
+
+    removeTestFiles();
+    if (failures == 0) {
+        std::cout << "OK" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}